@@ -0,0 +1,15 @@
+// Per-frame data shared by every shader, updated once per frame.
+// Layout must match FrameUniforms::FrameData (Rendering/FrameUniforms.h)
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+
+    // xy = viewport size, zw = 1 / viewport size
+    vec4 viewport;
+
+    // AnimationClock time, so frames can be picked on the GPU
+    float time;
+    float deltaTime;
+    int frameIndex;
+};
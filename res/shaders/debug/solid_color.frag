@@ -1,10 +1,12 @@
 #version 410
 
-out vec4 outColor;
+#include "../common/frame_data.glsl"
+
+in vec4 color;
 
-uniform vec3 color;
+out vec4 outColor;
 
 void main()
 {   
-    outColor = vec4(color, 1.0);
+    outColor = color;
 }  
\ No newline at end of file
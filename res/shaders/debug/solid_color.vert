@@ -1,10 +1,14 @@
 #version 410
 
+#include "../common/frame_data.glsl"
+
 layout (location = 0) in vec2 vertex;
+layout (location = 1) in vec4 vertexColor;
 
-uniform mat4 projection;
+out vec4 color;
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
-}
\ No newline at end of file
+    color = vertexColor;
+    gl_Position = projection * view * vec4(vertex.xy, 0.0, 1.0);
+}
@@ -1,13 +1,15 @@
 #version 410
 
+#include "common/frame_data.glsl"
+
 in vec2 TexCoords;
+in vec4 TextColor;
 out vec4 color;
 
 uniform sampler2D text;
-uniform vec3 textColor;
 
 void main()
 {    
     vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).a);
-    color = vec4(textColor, 1.0) * sampled;
-}  
\ No newline at end of file
+    color = TextColor * sampled;
+}
@@ -1,12 +1,16 @@
 #version 410
 
+#include "common/frame_data.glsl"
+
 layout (location = 0) in vec4 vertex;
-out vec2 TexCoords;
+layout (location = 1) in vec4 vertexColor;
 
-uniform mat4 projection;
+out vec2 TexCoords;
+out vec4 TextColor;
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = projection * view * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
-}  
\ No newline at end of file
+    TextColor = vertexColor;
+}
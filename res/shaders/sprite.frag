@@ -1,25 +1,56 @@
 #version 410
 
+#include "common/frame_data.glsl"
+
 in vec2 TexCoords;
-out vec4 color;
+in vec3 SpriteColor;
 
-uniform sampler2D image;
-uniform vec3 spriteColor;
+// Must match SPRITE_FLIP_* (Core/Math/Affine2D.h)
+const int FLIP_HORIZONTAL = 1;
+const int FLIP_VERTICAL   = 2;
+const int FLIP_DIAGONAL   = 4;
+
+// x/y divisions, frame index and flip bits
+flat in ivec4 Frame;
+
+// Atlas region (min, max) in page coordinates
+flat in vec4 UVRect;
 
-uniform int xDivisions = 1;
-uniform int yDivisions = 1;
+out vec4 color;
 
-uniform int frame = 0;
+uniform sampler2D image;
 
 void main()
 {   
+    int xDivisions = Frame.x;
+    int yDivisions = Frame.y;
+    int frame = Frame.z;
+    int flip = Frame.w;
+    
+    // Horizontal, then vertical, then diagonal (like Tiled)
+    vec2 local = TexCoords;
+    
+    if ((flip & FLIP_HORIZONTAL) != 0)
+    {
+        local.x = 1.0 - local.x;
+    }
+    if ((flip & FLIP_VERTICAL) != 0)
+    {
+        local.y = 1.0 - local.y;
+    }
+    if ((flip & FLIP_DIAGONAL) != 0)
+    {
+        local = local.yx;
+    }
+    
     vec2 frameSize = vec2(1.0) / vec2(xDivisions, yDivisions);
     
     int row = frame % xDivisions;
     int column = frame / xDivisions;
 
     vec2 frameOffset = vec2(row, column) * frameSize;
-    vec2 frameCoords = TexCoords * frameSize + frameOffset;
+    vec2 frameCoords = local * frameSize + frameOffset;
+    vec2 atlasCoords = mix(UVRect.xy, UVRect.zw, frameCoords);
 
-    color = vec4(spriteColor, 1.0) * texture(image, frameCoords);
-}  
\ No newline at end of file
+    color = vec4(SpriteColor, 1.0) * texture(image, atlasCoords);
+}  
@@ -1,14 +1,30 @@
 #version 410
 
+#include "common/frame_data.glsl"
+
 layout (location = 0) in vec4 vertex;
 
-out vec2 TexCoords;
+// Per-instance data
+layout (location = 1) in vec4 instanceLinear;
+layout (location = 2) in vec2 instanceTranslation;
+layout (location = 5) in vec4 instanceColor;
+layout (location = 6) in ivec4 instanceFrame;
+layout (location = 7) in vec4 instanceUVRect;
 
-uniform mat4 model;
-uniform mat4 projection;
+out vec2 TexCoords;
+out vec3 SpriteColor;
+flat out ivec4 Frame;
+flat out vec4 UVRect;
 
 void main()
 {
     TexCoords = vertex.zw;
-    gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
-}
\ No newline at end of file
+    SpriteColor = instanceColor.rgb;
+    Frame = instanceFrame;
+    UVRect = instanceUVRect;
+    
+    mat2 linear = mat2(instanceLinear.xy, instanceLinear.zw);
+    vec2 position = linear * vertex.xy + instanceTranslation;
+    
+    gl_Position = projection * view * vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 410
+
+#include "common/frame_data.glsl"
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D image;
+
+void main()
+{
+    color = texture(image, TexCoords);
+}
@@ -0,0 +1,14 @@
+#version 410
+
+#include "common/frame_data.glsl"
+
+// xy = world position, zw = tileset UV
+layout (location = 0) in vec4 vertex;
+
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = vertex.zw;
+    gl_Position = projection * view * vec4(vertex.xy, 0.0, 1.0);
+}
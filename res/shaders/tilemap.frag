@@ -0,0 +1,89 @@
+#version 410
+
+#include "common/frame_data.glsl"
+
+// Must match TILEMAP_MAX_TILESETS (IO/Tilemap/Tilemap.h)
+#define MAX_TILESETS 4
+
+const uint FLIPPED_HORIZONTALLY_FLAG = 0x80000000u;
+const uint FLIPPED_VERTICALLY_FLAG   = 0x40000000u;
+const uint FLIPPED_DIAGONALLY_FLAG   = 0x20000000u;
+const uint GID_MASK                  = 0x0FFFFFFFu;
+
+in vec2 LayerCoords;
+out vec4 color;
+
+// One texel per cell: Tiled GID with flip flags
+uniform usampler2D layerData;
+
+// Layer size in tiles
+uniform vec2 layerSize;
+
+uniform int tilesetCount;
+uniform int tilesetFirstGID[MAX_TILESETS];
+uniform vec2 tilesetDivisions[MAX_TILESETS];
+
+// Region (min, max) of the bound page each tileset occupies
+uniform vec4 tilesetRects[MAX_TILESETS];
+uniform sampler2D tilesets[MAX_TILESETS];
+
+vec4 SampleTileset(int index, vec2 uv)
+{
+    // Sampler arrays need constant indices in GLSL 4.1
+    if (index == 0) return texture(tilesets[0], uv);
+    if (index == 1) return texture(tilesets[1], uv);
+    if (index == 2) return texture(tilesets[2], uv);
+    return texture(tilesets[3], uv);
+}
+
+void main()
+{
+    vec2 cellCoords = LayerCoords * layerSize;
+    ivec2 cell = ivec2(floor(cellCoords));
+
+    uint gid = texelFetch(layerData, cell, 0).r;
+    int tileID = int(gid & GID_MASK);
+
+    if (tileID == 0)
+    {
+        discard;
+    }
+
+    // Undo Tiled's flips (diagonal first, then horizontal and vertical)
+    vec2 local = fract(cellCoords);
+
+    if ((gid & FLIPPED_HORIZONTALLY_FLAG) != 0u)
+    {
+        local.x = 1.0 - local.x;
+    }
+    if ((gid & FLIPPED_VERTICALLY_FLAG) != 0u)
+    {
+        local.y = 1.0 - local.y;
+    }
+    if ((gid & FLIPPED_DIAGONALLY_FLAG) != 0u)
+    {
+        local = local.yx;
+    }
+
+    // Find the tileset with the largest first GID <= tileID
+    int tileset = 0;
+
+    for (int i = 1; i < MAX_TILESETS; i++)
+    {
+        if (i < tilesetCount && tilesetFirstGID[i] <= tileID)
+        {
+            tileset = i;
+        }
+    }
+
+    int tileIndex = tileID - tilesetFirstGID[tileset];
+    vec2 divisions = tilesetDivisions[tileset];
+
+    int xDivisions = int(divisions.x);
+    vec2 tileCoords = vec2(tileIndex % xDivisions, tileIndex / xDivisions);
+
+    vec4 rect = tilesetRects[tileset];
+    vec2 uv = mix(rect.xy, rect.zw, (tileCoords + local) / divisions);
+
+    color = SampleTileset(tileset, uv);
+}
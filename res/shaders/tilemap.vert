@@ -0,0 +1,16 @@
+#version 410
+
+#include "common/frame_data.glsl"
+
+layout (location = 0) in vec4 vertex;
+
+out vec2 LayerCoords;
+
+// Layer size in world units
+uniform vec2 layerWorldSize;
+
+void main()
+{
+    LayerCoords = vertex.zw;
+    gl_Position = projection * view * vec4(vertex.xy * layerWorldSize, 0.0, 1.0);
+}
@@ -0,0 +1,47 @@
+#include "AnimationClock.h"
+
+#include <algorithm>
+
+double AnimationClock::m_time = 0.0;
+bool AnimationClock::m_paused = false;
+float AnimationClock::m_timeScale = 1.0F;
+
+void AnimationClock::Advance(float tickTime)
+{
+    if (m_paused)
+    {
+        return;
+    }
+
+    m_time += (double)(tickTime * m_timeScale);
+}
+
+void AnimationClock::Reset()
+{
+    m_time = 0.0;
+}
+
+double AnimationClock::GetTime()
+{
+    return m_time;
+}
+
+void AnimationClock::SetPaused(bool paused)
+{
+    m_paused = paused;
+}
+
+bool AnimationClock::IsPaused()
+{
+    return m_paused;
+}
+
+void AnimationClock::SetTimeScale(float timeScale)
+{
+    m_timeScale = std::max(timeScale, 0.0F);
+}
+
+float AnimationClock::GetTimeScale()
+{
+    return m_timeScale;
+}
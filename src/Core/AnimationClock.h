@@ -0,0 +1,32 @@
+#pragma once
+
+// Flipbooks with shorter (or invalid) frames are clamped to this
+#define ANIMATION_MIN_FRAME_DURATION 0.001F
+
+// Time every animation is played against. Advanced once per
+// simulation tick, so animation follows the simulation (and
+// replays identically) rather than the wall clock.
+class AnimationClock
+{
+public:
+    // Scaled by the time scale, ignored while paused
+    static void Advance(float tickTime);
+    static void Reset();
+
+    // Seconds of animation time since the last Reset()
+    [[nodiscard]]
+    static double GetTime();
+
+    static void SetPaused(bool paused);
+    [[nodiscard]]
+    static bool IsPaused();
+
+    static void SetTimeScale(float timeScale);
+    [[nodiscard]]
+    static float GetTimeScale();
+
+private:
+    static double m_time;
+    static bool m_paused;
+    static float m_timeScale;
+};
@@ -0,0 +1,573 @@
+#include "Affine2D.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AFFINE2D_X86
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AFFINE2D_TARGET_AVX
+#else
+#define AFFINE2D_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+// Flip matrices [A C; B D] for every combination of flip bits,
+// equal to H * V * Diag with the bits that are set
+static const float FLIP_LUT[8][4] =
+{
+    {  1.0F,  0.0F,  0.0F,  1.0F },
+    { -1.0F,  0.0F,  0.0F,  1.0F },
+    {  1.0F,  0.0F,  0.0F, -1.0F },
+    { -1.0F,  0.0F,  0.0F, -1.0F },
+    {  0.0F,  1.0F,  1.0F,  0.0F },
+    {  0.0F,  1.0F, -1.0F,  0.0F },
+    {  0.0F, -1.0F,  1.0F,  0.0F },
+    {  0.0F, -1.0F, -1.0F,  0.0F }
+};
+
+// Polynomial sine/cosine (Cephes), shared by the SIMD kernels.
+// Accurate to a few ULP for the angles sprites use.
+#define SINCOS_TWO_OVER_PI      0.636619772F
+#define SINCOS_PI_OVER_2_HI     1.5703125F
+#define SINCOS_PI_OVER_2_MID    4.837512969970703125e-4F
+#define SINCOS_PI_OVER_2_LO     7.54978995489188216e-8F
+
+#define SINCOS_S1   -1.6666654611e-1F
+#define SINCOS_S2    8.3321608736e-3F
+#define SINCOS_S3   -1.9515295891e-4F
+#define SINCOS_C1    4.166664568298827e-2F
+#define SINCOS_C2   -1.388731625493765e-3F
+#define SINCOS_C3    2.443315711809948e-5F
+
+Affine2D Affine2D::FromTransform(
+    glm::vec2 position,
+    glm::vec2 size,
+    glm::vec2 pivot,
+    float rotation,
+    int flip)
+{
+    float c = std::cos(rotation);
+    float s = std::sin(rotation);
+
+    const float* f = FLIP_LUT[flip & 7];
+
+    // Linear part: rotation * flip * size
+    Affine2D result = {};
+    result.A = (c * f[0] - s * f[1]) * size.x;
+    result.B = (s * f[0] + c * f[1]) * size.x;
+    result.C = (c * f[2] - s * f[3]) * size.y;
+    result.D = (s * f[2] + c * f[3]) * size.y;
+
+    // The pivot stays in place
+    result.TX = position.x + pivot.x * size.x -
+        (result.A * pivot.x + result.C * pivot.y);
+    result.TY = position.y + pivot.y * size.y -
+        (result.B * pivot.x + result.D * pivot.y);
+
+    return result;
+}
+
+Affine2D Affine2D::operator*(const Affine2D& rhs) const
+{
+    Affine2D result = {};
+    result.A = A * rhs.A + C * rhs.B;
+    result.B = B * rhs.A + D * rhs.B;
+    result.C = A * rhs.C + C * rhs.D;
+    result.D = B * rhs.C + D * rhs.D;
+    result.TX = A * rhs.TX + C * rhs.TY + TX;
+    result.TY = B * rhs.TX + D * rhs.TY + TY;
+
+    return result;
+}
+
+glm::vec2 Affine2D::Apply(glm::vec2 point) const
+{
+    return {
+        A * point.x + C * point.y + TX,
+        B * point.x + D * point.y + TY
+    };
+}
+
+glm::mat4 Affine2D::ToMat4() const
+{
+    return glm::mat4(
+        A,    B,    0.0F, 0.0F,
+        C,    D,    0.0F, 0.0F,
+        0.0F, 0.0F, 1.0F, 0.0F,
+        TX,   TY,   0.0F, 1.0F
+    );
+}
+
+glm::vec4 Affine2D::GetQuadBounds() const
+{
+    return {
+        TX + std::min(A, 0.0F) + std::min(C, 0.0F),
+        TY + std::min(B, 0.0F) + std::min(D, 0.0F),
+        TX + std::max(A, 0.0F) + std::max(C, 0.0F),
+        TY + std::max(B, 0.0F) + std::max(D, 0.0F)
+    };
+}
+
+static void ComputeAffinesScalar(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds,
+    size_t first)
+{
+    for (size_t i = first; i < batch.Count; i++)
+    {
+        glm::vec2 position = { batch.PositionX[i], batch.PositionY[i] };
+        glm::vec2 size = { batch.SizeX[i], batch.SizeY[i] };
+        glm::vec2 pivot = { batch.PivotX[i], batch.PivotY[i] };
+        int flip = batch.Flip ? batch.Flip[i] : 0;
+
+        models[i] = Affine2D::FromTransform(
+            position,
+            size,
+            pivot,
+            batch.Rotation[i],
+            flip
+        );
+
+        if (worlds)
+        {
+            // Rotation around the pivot only
+            float c = std::cos(batch.Rotation[i]);
+            float s = std::sin(batch.Rotation[i]);
+            glm::vec2 offset = pivot * size;
+
+            worlds[i] = { c, s, -s, c, 0.0F, 0.0F };
+            worlds[i].TX = position.x + offset.x -
+                (c * offset.x - s * offset.y);
+            worlds[i].TY = position.y + offset.y -
+                (s * offset.x + c * offset.y);
+        }
+    }
+}
+
+#ifdef AFFINE2D_X86
+
+static void SinCos4(__m128 x, __m128& sin, __m128& cos)
+{
+    // Reduce to [-pi/4, pi/4] and the quadrant
+    __m128i quadrant = _mm_cvtps_epi32(
+        _mm_mul_ps(x, _mm_set1_ps(SINCOS_TWO_OVER_PI))
+    );
+    __m128 q = _mm_cvtepi32_ps(quadrant);
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_OVER_2_HI)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_OVER_2_MID)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_OVER_2_LO)));
+
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(
+        _mm_mul_ps(_mm_set1_ps(SINCOS_S3), r2),
+        _mm_set1_ps(SINCOS_S2)
+    );
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(SINCOS_S1));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+    __m128 c = _mm_add_ps(
+        _mm_mul_ps(_mm_set1_ps(SINCOS_C3), r2),
+        _mm_set1_ps(SINCOS_C2)
+    );
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(SINCOS_C1));
+    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+    c = _mm_add_ps(
+        _mm_sub_ps(_mm_set1_ps(1.0F), _mm_mul_ps(r2, _mm_set1_ps(0.5F))),
+        c
+    );
+
+    // Odd quadrants swap sine and cosine
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+        _mm_and_si128(quadrant, _mm_set1_epi32(1)),
+        _mm_set1_epi32(1)
+    ));
+
+    sin = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+    cos = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+    // Signs from bit 1 of the quadrant (and of quadrant + 1)
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_and_si128(quadrant, _mm_set1_epi32(2)),
+        30
+    ));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_and_si128(
+            _mm_add_epi32(quadrant, _mm_set1_epi32(1)),
+            _mm_set1_epi32(2)
+        ),
+        30
+    ));
+
+    sin = _mm_xor_ps(sin, sinSign);
+    cos = _mm_xor_ps(cos, cosSign);
+}
+
+static void ComputeAffinesSSE2(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= batch.Count; i += 4)
+    {
+        __m128 positionX = _mm_loadu_ps(batch.PositionX + i);
+        __m128 positionY = _mm_loadu_ps(batch.PositionY + i);
+        __m128 sizeX = _mm_loadu_ps(batch.SizeX + i);
+        __m128 sizeY = _mm_loadu_ps(batch.SizeY + i);
+        __m128 pivotX = _mm_loadu_ps(batch.PivotX + i);
+        __m128 pivotY = _mm_loadu_ps(batch.PivotY + i);
+
+        __m128 sin, cos;
+        SinCos4(_mm_loadu_ps(batch.Rotation + i), sin, cos);
+
+        // Pivot in world units
+        __m128 offsetX = _mm_mul_ps(pivotX, sizeX);
+        __m128 offsetY = _mm_mul_ps(pivotY, sizeY);
+
+        __m128 flipA = _mm_set1_ps(1.0F);
+        __m128 flipB = _mm_setzero_ps();
+        __m128 flipC = _mm_setzero_ps();
+        __m128 flipD = _mm_set1_ps(1.0F);
+
+        if (batch.Flip)
+        {
+            const float* f0 = FLIP_LUT[batch.Flip[i + 0] & 7];
+            const float* f1 = FLIP_LUT[batch.Flip[i + 1] & 7];
+            const float* f2 = FLIP_LUT[batch.Flip[i + 2] & 7];
+            const float* f3 = FLIP_LUT[batch.Flip[i + 3] & 7];
+
+            flipA = _mm_setr_ps(f0[0], f1[0], f2[0], f3[0]);
+            flipB = _mm_setr_ps(f0[1], f1[1], f2[1], f3[1]);
+            flipC = _mm_setr_ps(f0[2], f1[2], f2[2], f3[2]);
+            flipD = _mm_setr_ps(f0[3], f1[3], f2[3], f3[3]);
+        }
+
+        // Linear part: rotation * flip * size
+        __m128 a = _mm_mul_ps(_mm_sub_ps(
+            _mm_mul_ps(cos, flipA), _mm_mul_ps(sin, flipB)), sizeX);
+        __m128 b = _mm_mul_ps(_mm_add_ps(
+            _mm_mul_ps(sin, flipA), _mm_mul_ps(cos, flipB)), sizeX);
+        __m128 c = _mm_mul_ps(_mm_sub_ps(
+            _mm_mul_ps(cos, flipC), _mm_mul_ps(sin, flipD)), sizeY);
+        __m128 d = _mm_mul_ps(_mm_add_ps(
+            _mm_mul_ps(sin, flipC), _mm_mul_ps(cos, flipD)), sizeY);
+
+        __m128 pivotOriginX = _mm_add_ps(positionX, offsetX);
+        __m128 pivotOriginY = _mm_add_ps(positionY, offsetY);
+
+        __m128 tx = _mm_sub_ps(pivotOriginX, _mm_add_ps(
+            _mm_mul_ps(a, pivotX), _mm_mul_ps(c, pivotY)));
+        __m128 ty = _mm_sub_ps(pivotOriginY, _mm_add_ps(
+            _mm_mul_ps(b, pivotX), _mm_mul_ps(d, pivotY)));
+
+        alignas(16) float out[6][4];
+        _mm_store_ps(out[0], a);
+        _mm_store_ps(out[1], b);
+        _mm_store_ps(out[2], c);
+        _mm_store_ps(out[3], d);
+        _mm_store_ps(out[4], tx);
+        _mm_store_ps(out[5], ty);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            models[i + lane] = {
+                out[0][lane], out[1][lane],
+                out[2][lane], out[3][lane],
+                out[4][lane], out[5][lane]
+            };
+        }
+
+        if (worlds)
+        {
+            // Rotation around the pivot only
+            __m128 worldX = _mm_sub_ps(pivotOriginX, _mm_sub_ps(
+                _mm_mul_ps(cos, offsetX), _mm_mul_ps(sin, offsetY)));
+            __m128 worldY = _mm_sub_ps(pivotOriginY, _mm_add_ps(
+                _mm_mul_ps(sin, offsetX), _mm_mul_ps(cos, offsetY)));
+
+            _mm_store_ps(out[0], cos);
+            _mm_store_ps(out[1], sin);
+            _mm_store_ps(out[4], worldX);
+            _mm_store_ps(out[5], worldY);
+
+            for (int lane = 0; lane < 4; lane++)
+            {
+                worlds[i + lane] = {
+                    out[0][lane], out[1][lane],
+                    -out[1][lane], out[0][lane],
+                    out[4][lane], out[5][lane]
+                };
+            }
+        }
+    }
+
+    ComputeAffinesScalar(batch, models, worlds, i);
+}
+
+AFFINE2D_TARGET_AVX
+static void SinCos8(__m256 x, __m256& sin, __m256& cos)
+{
+    // AVX1 has no 256-bit integer ops, so quadrant logic runs on
+    // floats: q is the rounded quadrant, bits are tested by halving
+    __m256 q = _mm256_round_ps(
+        _mm256_mul_ps(x, _mm256_set1_ps(SINCOS_TWO_OVER_PI)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+    );
+
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_OVER_2_HI)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_OVER_2_MID)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_OVER_2_LO)));
+
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_add_ps(
+        _mm256_mul_ps(_mm256_set1_ps(SINCOS_S3), r2),
+        _mm256_set1_ps(SINCOS_S2)
+    );
+    s = _mm256_add_ps(_mm256_mul_ps(s, r2), _mm256_set1_ps(SINCOS_S1));
+    s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, r2), r), r);
+
+    __m256 c = _mm256_add_ps(
+        _mm256_mul_ps(_mm256_set1_ps(SINCOS_C3), r2),
+        _mm256_set1_ps(SINCOS_C2)
+    );
+    c = _mm256_add_ps(_mm256_mul_ps(c, r2), _mm256_set1_ps(SINCOS_C1));
+    c = _mm256_mul_ps(_mm256_mul_ps(c, r2), r2);
+    c = _mm256_add_ps(
+        _mm256_sub_ps(_mm256_set1_ps(1.0F), _mm256_mul_ps(r2, _mm256_set1_ps(0.5F))),
+        c
+    );
+
+    // q mod 4 in [0, 4)
+    __m256 quarter = _mm256_mul_ps(q, _mm256_set1_ps(0.25F));
+    __m256 quadrant = _mm256_mul_ps(
+        _mm256_sub_ps(quarter, _mm256_floor_ps(quarter)),
+        _mm256_set1_ps(4.0F)
+    );
+
+    __m256 one = _mm256_set1_ps(1.0F);
+    __m256 two = _mm256_set1_ps(2.0F);
+    __m256 three = _mm256_set1_ps(3.0F);
+
+    // Quadrants 1 and 3 swap sine and cosine
+    __m256 swap = _mm256_or_ps(
+        _mm256_cmp_ps(quadrant, one, _CMP_EQ_OQ),
+        _mm256_cmp_ps(quadrant, three, _CMP_EQ_OQ)
+    );
+
+    sin = _mm256_blendv_ps(s, c, swap);
+    cos = _mm256_blendv_ps(c, s, swap);
+
+    // Sine is negative in quadrants 2 and 3, cosine in 1 and 2
+    __m256 signBit = _mm256_set1_ps(-0.0F);
+    __m256 sinNegative = _mm256_cmp_ps(quadrant, two, _CMP_GE_OQ);
+    __m256 cosNegative = _mm256_and_ps(
+        _mm256_cmp_ps(quadrant, one, _CMP_GE_OQ),
+        _mm256_cmp_ps(quadrant, two, _CMP_LE_OQ)
+    );
+
+    sin = _mm256_xor_ps(sin, _mm256_and_ps(sinNegative, signBit));
+    cos = _mm256_xor_ps(cos, _mm256_and_ps(cosNegative, signBit));
+}
+
+AFFINE2D_TARGET_AVX
+static void ComputeAffinesAVX(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= batch.Count; i += 8)
+    {
+        __m256 positionX = _mm256_loadu_ps(batch.PositionX + i);
+        __m256 positionY = _mm256_loadu_ps(batch.PositionY + i);
+        __m256 sizeX = _mm256_loadu_ps(batch.SizeX + i);
+        __m256 sizeY = _mm256_loadu_ps(batch.SizeY + i);
+        __m256 pivotX = _mm256_loadu_ps(batch.PivotX + i);
+        __m256 pivotY = _mm256_loadu_ps(batch.PivotY + i);
+
+        __m256 sin, cos;
+        SinCos8(_mm256_loadu_ps(batch.Rotation + i), sin, cos);
+
+        __m256 offsetX = _mm256_mul_ps(pivotX, sizeX);
+        __m256 offsetY = _mm256_mul_ps(pivotY, sizeY);
+
+        __m256 flipA = _mm256_set1_ps(1.0F);
+        __m256 flipB = _mm256_setzero_ps();
+        __m256 flipC = _mm256_setzero_ps();
+        __m256 flipD = _mm256_set1_ps(1.0F);
+
+        if (batch.Flip)
+        {
+            alignas(32) float lanes[4][8];
+
+            for (int lane = 0; lane < 8; lane++)
+            {
+                const float* f = FLIP_LUT[batch.Flip[i + lane] & 7];
+
+                lanes[0][lane] = f[0];
+                lanes[1][lane] = f[1];
+                lanes[2][lane] = f[2];
+                lanes[3][lane] = f[3];
+            }
+
+            flipA = _mm256_load_ps(lanes[0]);
+            flipB = _mm256_load_ps(lanes[1]);
+            flipC = _mm256_load_ps(lanes[2]);
+            flipD = _mm256_load_ps(lanes[3]);
+        }
+
+        __m256 a = _mm256_mul_ps(_mm256_sub_ps(
+            _mm256_mul_ps(cos, flipA), _mm256_mul_ps(sin, flipB)), sizeX);
+        __m256 b = _mm256_mul_ps(_mm256_add_ps(
+            _mm256_mul_ps(sin, flipA), _mm256_mul_ps(cos, flipB)), sizeX);
+        __m256 c = _mm256_mul_ps(_mm256_sub_ps(
+            _mm256_mul_ps(cos, flipC), _mm256_mul_ps(sin, flipD)), sizeY);
+        __m256 d = _mm256_mul_ps(_mm256_add_ps(
+            _mm256_mul_ps(sin, flipC), _mm256_mul_ps(cos, flipD)), sizeY);
+
+        __m256 pivotOriginX = _mm256_add_ps(positionX, offsetX);
+        __m256 pivotOriginY = _mm256_add_ps(positionY, offsetY);
+
+        __m256 tx = _mm256_sub_ps(pivotOriginX, _mm256_add_ps(
+            _mm256_mul_ps(a, pivotX), _mm256_mul_ps(c, pivotY)));
+        __m256 ty = _mm256_sub_ps(pivotOriginY, _mm256_add_ps(
+            _mm256_mul_ps(b, pivotX), _mm256_mul_ps(d, pivotY)));
+
+        alignas(32) float out[6][8];
+        _mm256_store_ps(out[0], a);
+        _mm256_store_ps(out[1], b);
+        _mm256_store_ps(out[2], c);
+        _mm256_store_ps(out[3], d);
+        _mm256_store_ps(out[4], tx);
+        _mm256_store_ps(out[5], ty);
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            models[i + lane] = {
+                out[0][lane], out[1][lane],
+                out[2][lane], out[3][lane],
+                out[4][lane], out[5][lane]
+            };
+        }
+
+        if (worlds)
+        {
+            __m256 worldX = _mm256_sub_ps(pivotOriginX, _mm256_sub_ps(
+                _mm256_mul_ps(cos, offsetX), _mm256_mul_ps(sin, offsetY)));
+            __m256 worldY = _mm256_sub_ps(pivotOriginY, _mm256_add_ps(
+                _mm256_mul_ps(sin, offsetX), _mm256_mul_ps(cos, offsetY)));
+
+            _mm256_store_ps(out[0], cos);
+            _mm256_store_ps(out[1], sin);
+            _mm256_store_ps(out[4], worldX);
+            _mm256_store_ps(out[5], worldY);
+
+            for (int lane = 0; lane < 8; lane++)
+            {
+                worlds[i + lane] = {
+                    out[0][lane], out[1][lane],
+                    -out[1][lane], out[0][lane],
+                    out[4][lane], out[5][lane]
+                };
+            }
+        }
+    }
+
+    // Finish the tail four at a time where possible
+    AffineBatch tail = batch;
+    tail.PositionX += i;
+    tail.PositionY += i;
+    tail.SizeX += i;
+    tail.SizeY += i;
+    tail.PivotX += i;
+    tail.PivotY += i;
+    tail.Rotation += i;
+    tail.Flip = batch.Flip ? batch.Flip + i : nullptr;
+    tail.Count -= i;
+
+    ComputeAffinesSSE2(tail, models + i, worlds ? worlds + i : nullptr);
+}
+
+#endif
+
+EAffineKernel GetBestAffineKernel()
+{
+#ifdef AFFINE2D_X86
+#ifdef _MSC_VER
+    static const bool hasAVX = []()
+    {
+        int info[4];
+        __cpuid(info, 1);
+
+        // AVX and OS support for saving YMM registers
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+
+        return avx && osxsave &&
+            (_xgetbv(0) & 0x6) == 0x6;
+    }();
+#else
+    static const bool hasAVX = __builtin_cpu_supports("avx");
+#endif
+
+    return hasAVX ? EAffineKernel::AVX : EAffineKernel::SSE2;
+#else
+    return EAffineKernel::Scalar;
+#endif
+}
+
+const char* GetAffineKernelName(EAffineKernel kernel)
+{
+    switch (kernel)
+    {
+    case EAffineKernel::SSE2:
+        return "SSE2";
+    case EAffineKernel::AVX:
+        return "AVX";
+    default:
+        return "Scalar";
+    }
+}
+
+void ComputeAffines(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds)
+{
+    static const EAffineKernel kernel = GetBestAffineKernel();
+
+    ComputeAffines(batch, models, worlds, kernel);
+}
+
+void ComputeAffines(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds,
+    EAffineKernel kernel)
+{
+#ifdef AFFINE2D_X86
+    if (kernel == EAffineKernel::AVX)
+    {
+        ComputeAffinesAVX(batch, models, worlds);
+        return;
+    }
+
+    if (kernel == EAffineKernel::SSE2)
+    {
+        ComputeAffinesSSE2(batch, models, worlds);
+        return;
+    }
+#endif
+
+    ComputeAffinesScalar(batch, models, worlds, 0);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Sprite flip bits. Applied like Tiled: horizontal, then vertical,
+// then diagonal. Must match res/shaders/sprite.frag.
+#define SPRITE_FLIP_HORIZONTAL  1
+#define SPRITE_FLIP_VERTICAL    2
+#define SPRITE_FLIP_DIAGONAL    4
+
+// 2D affine transform: p' = [A C; B D] * p + [TX; TY]
+struct Affine2D
+{
+    float A = 1.0F;
+    float B = 0.0F;
+    float C = 0.0F;
+    float D = 1.0F;
+    float TX = 0.0F;
+    float TY = 0.0F;
+
+    // Unit quad -> world, rotating and flipping around the pivot.
+    // Scalar equivalent of ComputeAffines().
+    static Affine2D FromTransform(
+        glm::vec2 position,
+        glm::vec2 size,
+        glm::vec2 pivot,
+        float rotation,
+        int flip = 0
+    );
+
+    Affine2D operator*(const Affine2D& rhs) const;
+
+    [[nodiscard]]
+    glm::vec2 Apply(glm::vec2 point) const;
+
+    [[nodiscard]]
+    glm::mat4 ToMat4() const;
+
+    // Axis-aligned bounds of the transformed unit quad
+    // as (min x, min y, max x, max y)
+    [[nodiscard]]
+    glm::vec4 GetQuadBounds() const;
+};
+
+// Structure-of-arrays input of ComputeAffines(), every array holds
+// Count elements. Flip may be null if nothing is flipped.
+struct AffineBatch
+{
+    const float* PositionX = nullptr;
+    const float* PositionY = nullptr;
+    const float* SizeX = nullptr;
+    const float* SizeY = nullptr;
+    const float* PivotX = nullptr;
+    const float* PivotY = nullptr;
+    const float* Rotation = nullptr;
+    const uint8_t* Flip = nullptr;
+
+    size_t Count = 0;
+};
+
+enum EAffineKernel
+{
+    Scalar,
+    SSE2,
+    AVX
+};
+
+// Widest kernel supported by this build and CPU
+EAffineKernel GetBestAffineKernel();
+const char* GetAffineKernelName(EAffineKernel kernel);
+
+// Writes each element's model transform (size, pivot rotation and
+// flips) and, if `worlds` is given, the transform its children are
+// placed in (position and pivot rotation only)
+void ComputeAffines(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds = nullptr
+);
+void ComputeAffines(
+    const AffineBatch& batch,
+    Affine2D* models,
+    Affine2D* worlds,
+    EAffineKernel kernel
+);
@@ -0,0 +1,321 @@
+#include "Profiler.h"
+#include "Rendering/CommandList.h"
+#include "Rendering/Debug/GLTrace.h"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+
+Profiler::PassInfo Profiler::m_passes[ProfilePassCount] =
+{
+    { "Update", 2.0F },
+    { "Tilemap", 1.0F },
+    { "Sprites", 2.0F },
+    { "Fonts", 1.0F },
+    { "Upscale", 0.25F },
+    { "Debug", 0.5F },
+    { "ImGui build", 0.5F },
+    { "ImGui", 1.0F }
+};
+float Profiler::m_frameBudget = PROFILER_FRAME_BUDGET;
+
+unsigned int Profiler::m_queries[PROFILER_QUERY_FRAMES][ProfilePassCount] = {};
+bool Profiler::m_queryIssued[PROFILER_QUERY_FRAMES][ProfilePassCount] = {};
+int Profiler::m_queryFrame = 0;
+
+std::atomic<float> Profiler::m_gpuMilliseconds[ProfilePassCount] = {};
+
+std::chrono::steady_clock::time_point Profiler::m_frameStart;
+float Profiler::m_cpuFrame[ProfilePassCount] = {};
+float Profiler::m_cpuMilliseconds[ProfilePassCount] = {};
+float Profiler::m_gpuAverage[ProfilePassCount] = {};
+
+float Profiler::m_frameHistory[PROFILER_HISTORY] = {};
+float Profiler::m_gpuHistory[PROFILER_HISTORY] = {};
+int Profiler::m_historyIndex = 0;
+
+// Smoothing of the per-pass numbers, so they can be read
+static constexpr float s_averageWeight = 0.1F;
+
+static EGLTraceScope GetTraceScope(EProfilePass pass)
+{
+    switch (pass)
+    {
+        case ProfileTilemap:
+            return TraceTilemap;
+        case ProfileSprites:
+            return TraceSprites;
+        case ProfileFonts:
+            return TraceFonts;
+        case ProfileDebug:
+            return TraceDebug;
+        case ProfileImGui:
+            return TraceImGui;
+        default:
+            return TraceOther;
+    }
+}
+
+void Profiler::Init()
+{
+    for (auto& frame : m_queries)
+    {
+        glGenQueries(ProfilePassCount, frame);
+    }
+
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::Destroy()
+{
+    for (auto& frame : m_queries)
+    {
+        glDeleteQueries(ProfilePassCount, frame);
+    }
+}
+
+void Profiler::BeginFrame()
+{
+    auto now = std::chrono::steady_clock::now();
+    float frameMilliseconds =
+        std::chrono::duration<float, std::milli>(now - m_frameStart).count();
+    m_frameStart = now;
+
+    float gpuMilliseconds = 0.0F;
+
+    for (int pass = 0; pass < ProfilePassCount; pass++)
+    {
+        float gpu = m_gpuMilliseconds[pass];
+        gpuMilliseconds += gpu;
+
+        m_cpuMilliseconds[pass] +=
+            (m_cpuFrame[pass] - m_cpuMilliseconds[pass]) * s_averageWeight;
+        m_gpuAverage[pass] +=
+            (gpu - m_gpuAverage[pass]) * s_averageWeight;
+
+        m_cpuFrame[pass] = 0.0F;
+    }
+
+    m_frameHistory[m_historyIndex] = frameMilliseconds;
+    m_gpuHistory[m_historyIndex] = gpuMilliseconds;
+    m_historyIndex = (m_historyIndex + 1) % PROFILER_HISTORY;
+}
+
+void Profiler::BeginGPUFrame()
+{
+    m_queryFrame = (m_queryFrame + 1) % PROFILER_QUERY_FRAMES;
+
+    // Issued PROFILER_QUERY_FRAMES frames ago, usually done by now.
+    // Results that are still pending are dropped instead of waited on.
+    for (int pass = 0; pass < ProfilePassCount; pass++)
+    {
+        // Skipped that frame (e.g. no upscale), its old time would
+        // otherwise stay on forever
+        if (!m_queryIssued[m_queryFrame][pass])
+        {
+            m_gpuMilliseconds[pass] = 0.0F;
+            continue;
+        }
+
+        unsigned int query = m_queries[m_queryFrame][pass];
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available)
+        {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+
+            m_gpuMilliseconds[pass] = (float)nanoseconds / 1000000.0F;
+        }
+
+        m_queryIssued[m_queryFrame][pass] = false;
+    }
+}
+
+void Profiler::BeginGPUPass(EProfilePass pass)
+{
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, pass, -1, GetPassName(pass));
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_queryFrame][pass]);
+
+    GLTrace::SetScope(GetTraceScope(pass));
+}
+
+void Profiler::EndGPUPass(EProfilePass pass)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    glPopDebugGroup();
+
+    m_queryIssued[m_queryFrame][pass] = true;
+
+    GLTrace::SetScope(TraceOther);
+}
+
+void Profiler::AddCPUTime(EProfilePass pass, float milliseconds)
+{
+    m_cpuFrame[pass] += milliseconds;
+}
+
+void Profiler::DrawOverlay()
+{
+    ImGui::SeparatorText("Profiler:");
+
+    DrawFrameGraph("Frame", m_frameHistory, m_frameBudget);
+    DrawFrameGraph("GPU", m_gpuHistory, m_frameBudget);
+
+    ImGui::DragFloat("Frame budget", &m_frameBudget, 0.1F, 1.0F, 100.0F, "%.1f ms");
+
+    if (!ImGui::BeginTable("Passes", 4, ImGuiTableFlags_SizingStretchProp))
+    {
+        return;
+    }
+
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("CPU ms");
+    ImGui::TableSetupColumn("GPU ms");
+    ImGui::TableSetupColumn("Budget ms");
+    ImGui::TableHeadersRow();
+
+    const ImVec4 overBudget = ImVec4(1.0F, 0.3F, 0.3F, 1.0F);
+
+    for (int pass = 0; pass < ProfilePassCount; pass++)
+    {
+        PassInfo& info = m_passes[pass];
+
+        ImGui::PushID(pass);
+        ImGui::TableNextRow();
+
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(info.Name);
+
+        float cpu = m_cpuMilliseconds[pass];
+        float gpu = m_gpuAverage[pass];
+
+        ImGui::TableNextColumn();
+        if (cpu > info.Budget)
+        {
+            ImGui::TextColored(overBudget, "%.3f", cpu);
+        }
+        else
+        {
+            ImGui::Text("%.3f", cpu);
+        }
+
+        ImGui::TableNextColumn();
+        if (IsCPUOnly((EProfilePass)pass))
+        {
+            ImGui::TextDisabled("-");
+        }
+        else if (gpu > info.Budget)
+        {
+            ImGui::TextColored(overBudget, "%.3f", gpu);
+        }
+        else
+        {
+            ImGui::Text("%.3f", gpu);
+        }
+
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::DragFloat("##Budget", &info.Budget, 0.01F, 0.0F, 100.0F, "%.2f");
+
+        ImGui::PopID();
+    }
+
+    ImGui::EndTable();
+}
+
+const char* Profiler::GetPassName(EProfilePass pass)
+{
+    return m_passes[pass].Name;
+}
+
+bool Profiler::IsCPUOnly(EProfilePass pass)
+{
+    return pass == ProfileUpdate || pass == ProfileImGuiBuild;
+}
+
+float Profiler::GetPercentile(const float* history, float percentile)
+{
+    float sorted[PROFILER_HISTORY];
+    std::copy(history, history + PROFILER_HISTORY, sorted);
+
+    int index = (int)(percentile * (PROFILER_HISTORY - 1));
+    std::nth_element(sorted, sorted + index, sorted + PROFILER_HISTORY);
+
+    return sorted[index];
+}
+
+void Profiler::DrawFrameGraph(
+    const char* label,
+    const float* history,
+    float budget)
+{
+    float p50 = GetPercentile(history, 0.50F);
+    float p95 = GetPercentile(history, 0.95F);
+    float p99 = GetPercentile(history, 0.99F);
+
+    char overlay[64];
+    snprintf(
+        overlay,
+        sizeof(overlay),
+        "p50 %.2f  p95 %.2f  p99 %.2f",
+        p50,
+        p95,
+        p99
+    );
+
+    bool over = p95 > budget;
+
+    if (over)
+    {
+        ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(1.0F, 0.3F, 0.3F, 1.0F));
+    }
+
+    // Scaled to twice the budget so spikes stand out
+    ImGui::PlotLines(
+        label,
+        history,
+        PROFILER_HISTORY,
+        m_historyIndex,
+        overlay,
+        0.0F,
+        budget * 2.0F,
+        ImVec2(0.0F, 48.0F)
+    );
+
+    if (over)
+    {
+        ImGui::PopStyleColor();
+    }
+}
+
+ProfileScope::ProfileScope(EProfilePass pass)
+    : m_pass(pass),
+      m_start(std::chrono::steady_clock::now())
+{
+}
+
+ProfileScope::ProfileScope(CommandList& commands, EProfilePass pass)
+    : m_pass(pass),
+      m_commands(&commands),
+      m_start(std::chrono::steady_clock::now())
+{
+    m_commands->BeginPass(pass);
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (m_commands)
+    {
+        m_commands->EndPass(m_pass);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    Profiler::AddCPUTime(
+        m_pass,
+        std::chrono::duration<float, std::milli>(end - m_start).count()
+    );
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Frames of GPU queries in flight, results are read back this
+// many frames later so the CPU never waits on them
+#define PROFILER_QUERY_FRAMES   4
+
+// Frames kept for the frame-time graphs and percentiles
+#define PROFILER_HISTORY        240
+
+#define PROFILER_FRAME_BUDGET   (1000.0F / 60.0F)
+
+class CommandList;
+
+enum EProfilePass : uint8_t
+{
+    ProfileUpdate,
+    ProfileTilemap,
+    ProfileSprites,
+    ProfileFonts,
+    ProfileUpscale,
+    ProfileDebug,
+
+    // Building the ImGui windows (CPU only), then recording and
+    // drawing them
+    ProfileImGuiBuild,
+    ProfileImGui,
+    ProfilePassCount
+};
+
+// CPU scope timers and GL_TIME_ELAPSED queries per frame pass.
+// CPU time is measured on the recording thread, GPU time by query
+// pairs recorded into the command list and issued on replay.
+class Profiler
+{
+public:
+    // Needs the GL context
+    static void Init();
+    static void Destroy();
+
+    // Closes the previous frame on the recording thread
+    static void BeginFrame();
+
+    // Replay side, called on the thread that owns the context
+    static void BeginGPUFrame();
+    static void BeginGPUPass(EProfilePass pass);
+    static void EndGPUPass(EProfilePass pass);
+
+    static void AddCPUTime(EProfilePass pass, float milliseconds);
+
+    // Profiler section of the Debug Console
+    static void DrawOverlay();
+
+    [[nodiscard]]
+    static const char* GetPassName(EProfilePass pass);
+
+private:
+    struct PassInfo
+    {
+        const char* Name;
+        float Budget;
+    };
+
+    static float GetPercentile(const float* history, float percentile);
+    static void DrawFrameGraph(
+        const char* label,
+        const float* history,
+        float budget
+    );
+
+    static PassInfo m_passes[ProfilePassCount];
+    static float m_frameBudget;
+
+    // Passes only timed on the CPU
+    [[nodiscard]]
+    static bool IsCPUOnly(EProfilePass pass);
+
+    static unsigned int m_queries[PROFILER_QUERY_FRAMES][ProfilePassCount];
+    static bool m_queryIssued[PROFILER_QUERY_FRAMES][ProfilePassCount];
+    static int m_queryFrame;
+
+    // Written on the GL thread, read when closing a frame
+    static std::atomic<float> m_gpuMilliseconds[ProfilePassCount];
+
+    static std::chrono::steady_clock::time_point m_frameStart;
+    static float m_cpuFrame[ProfilePassCount];
+    static float m_cpuMilliseconds[ProfilePassCount];
+    static float m_gpuAverage[ProfilePassCount];
+
+    static float m_frameHistory[PROFILER_HISTORY];
+    static float m_gpuHistory[PROFILER_HISTORY];
+    static int m_historyIndex;
+};
+
+// Times a pass on the CPU until it goes out of scope. With a
+// command list the pass is also timed and labelled on the GPU.
+class ProfileScope
+{
+public:
+    explicit ProfileScope(EProfilePass pass);
+    ProfileScope(CommandList& commands, EProfilePass pass);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    EProfilePass m_pass;
+    CommandList* m_commands = nullptr;
+    std::chrono::steady_clock::time_point m_start;
+};
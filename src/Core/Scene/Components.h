@@ -1,13 +1,19 @@
 #pragma once
 
+#include "Core/AnimationClock.h"
+#include "Core/Log.h"
+#include "Core/Math/Affine2D.h"
 #include "Rendering/Texture.h"
 #include "Rendering/Shader.h"
 #include "Rendering/Font/BitmapFont.h"
 
-#include <GLFW/glfw3.h>
+#include <entt/entt.hpp>
 #include <glm/glm.hpp>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 typedef glm::vec4 Color;
 
@@ -35,6 +41,9 @@ struct TagComponent
         : Tag(tag) {};
 };
 
+// Once an entity exists, change its transform through
+// Entity::PatchComponent (or registry.patch) so TransformSystem
+// knows to rebuild its world matrix
 struct TransformComponent
 {
     glm::vec2 Position = { 0.0F, 0.0F };
@@ -60,10 +69,56 @@ struct TransformComponent
               Size(size) {}
 };
 
+// Cached by TransformSystem, read-only for everything else
+struct WorldTransformComponent
+{
+    // Space children are placed in: position and pivot rotation
+    Affine2D World;
+
+    // World scaled by the transform size, for drawing the unit quad
+    Affine2D Model;
+
+    bool Dirty = true;
+};
+
+// Entities with this are drawn between their transform of the
+// previous and the current simulation tick, see
+// TransformSystem::BeginTick
+struct InterpolatedTransformComponent
+{
+    glm::vec2 PreviousPosition = { 0.0F, 0.0F };
+    float PreviousRotation = 0.0F;
+
+    // Drawn in between ticks last frame
+    bool Blended = false;
+};
+
+// Managed through TransformSystem::SetParent
+struct HierarchyComponent
+{
+    entt::entity Parent = entt::null;
+    std::vector<entt::entity> Children;
+};
+
+// Coarse draw order, lower layers are drawn first. Values are
+// spaced out so related layers (e.g. tilemap layers) can be offset.
+enum ERenderLayer : uint8_t
+{
+    Background = 0,
+    Tiles = 16,
+    Actors = 128,
+    Overlay = 192
+};
+
 struct SpriteRendererComponent
 {
     Color ColorTint = { 1.0F, 1.0F, 1.0F, 1.0F };
 
+    // Draw order: sorted by layer first, then by depth
+    // within sprites sharing a texture
+    uint8_t Layer = ERenderLayer::Actors;
+    float Depth = 0.0F;
+
     bool FlipHorizontal = false;
     bool FlipVertical = false;
     bool FlipDiagonal = false;
@@ -80,6 +135,15 @@ struct SpriteRendererComponent
         ColorTint = color;
     }
     
+    SpriteRendererComponent(
+        const TextureRegion& region,
+        Color color)
+    {
+        SetTexture(region);
+        
+        ColorTint = color;
+    }
+    
     SpriteRendererComponent(Color color)
     {
         ColorTint = color;
@@ -88,6 +152,15 @@ struct SpriteRendererComponent
     void SetTexture(const std::shared_ptr<Texture>& texture)
     {
         m_spriteTexture = texture;
+        m_uvRect = glm::vec4(0.0F, 0.0F, 1.0F, 1.0F);
+        m_hasTexture = true;
+    }
+    
+    // Samples only the region's part of its atlas page
+    void SetTexture(const TextureRegion& region)
+    {
+        m_spriteTexture = region.Page;
+        m_uvRect = region.GetUVRect();
         m_hasTexture = true;
     }
     
@@ -96,6 +169,12 @@ struct SpriteRendererComponent
         return m_spriteTexture;
     }
     
+    // Normalized (min, max) texture coordinates
+    const glm::vec4& GetUVRect() const
+    {
+        return m_uvRect;
+    }
+    
     bool HasTexture() const
     {
         return m_hasTexture;
@@ -103,6 +182,7 @@ struct SpriteRendererComponent
     
 private:
     std::weak_ptr<Texture> m_spriteTexture;
+    glm::vec4 m_uvRect = { 0.0F, 0.0F, 1.0F, 1.0F };
     bool m_hasTexture = false;
 };
 
@@ -111,36 +191,36 @@ struct FlipbookComponent
     int Divisions = 1;
     float FrameDuration = 0.15F;
     
+    // AnimationClock time of the first frame
+    double StartTime = 0.0;
+    
+    // Written by the AnimationSystem
+    int Frame = 0;
+    
     FlipbookComponent()
     {
-        m_initialTime = (float)glfwGetTime();
-        m_currentTime = (float)glfwGetTime();
+        StartTime = AnimationClock::GetTime();
     }
     FlipbookComponent(
         int divisions,
         float frameDuration)
             : FlipbookComponent()
     {
-        Divisions = divisions;
-        FrameDuration = frameDuration;
-    }
-    FlipbookComponent(
-        const FlipbookComponent& other)
-            : FlipbookComponent()
-    {
-        Divisions = other.Divisions;
-        FrameDuration = other.FrameDuration;
-    }
-    
-    float GetCurrentTime()
-    {
-        m_currentTime = (float)glfwGetTime() - m_initialTime;
-        return m_currentTime;
+        // The AnimationSystem divides by one and wraps by the other
+        if (divisions < 1 || !(frameDuration >= ANIMATION_MIN_FRAME_DURATION))
+        {
+            Log::Warning(
+                "[FlipbookComponent] Invalid animation (%d divisions, %f s frames), clamped",
+                divisions,
+                frameDuration
+            );
+        }
+
+        Divisions = divisions < 1 ? 1 : divisions;
+        FrameDuration = frameDuration >= ANIMATION_MIN_FRAME_DURATION
+            ? frameDuration
+            : ANIMATION_MIN_FRAME_DURATION;
     }
-    
-private:
-    float m_initialTime = 0.0F;
-    float m_currentTime = 0.0F;
 };
 
 struct TileComponent
@@ -166,20 +246,78 @@ struct TileComponent
 
 struct FontRendererComponent
 {
-    std::string Text;
-    std::weak_ptr<BitmapFont> Font;
     Color FontColor = Color(1.0F);
     
-    float FontSize = 8.0F;
+    // Glyph quads relative to the transform position, rebuilt by
+    // the Renderer whenever MeshVersion falls behind GetVersion()
+    std::vector<glm::vec4> Mesh;
+    uint32_t MeshVersion = 0;
     
     FontRendererComponent() = default;
     FontRendererComponent(
         std::string text,
         const std::shared_ptr<BitmapFont>& font,
         float size)
-            : Text(std::move(text)),
-              Font(font),
-              FontSize(size) {}
+            : m_text(std::move(text)),
+              m_font(font),
+              m_fontSize(size) {}
+    
+    // Setters only bump the version when something changed, so
+    // a score re-set to the same value keeps its mesh
+    void SetText(std::string_view text)
+    {
+        if (text == m_text)
+        {
+            return;
+        }
+        
+        m_text.assign(text);
+        m_version += 1;
+    }
+    
+    void SetFont(const std::shared_ptr<BitmapFont>& font)
+    {
+        m_font = font;
+        m_version += 1;
+    }
+    
+    void SetFontSize(float size)
+    {
+        if (size == m_fontSize)
+        {
+            return;
+        }
+        
+        m_fontSize = size;
+        m_version += 1;
+    }
+    
+    const std::string& GetText() const
+    {
+        return m_text;
+    }
+    
+    const std::weak_ptr<BitmapFont>& GetFont() const
+    {
+        return m_font;
+    }
+    
+    float GetFontSize() const
+    {
+        return m_fontSize;
+    }
+    
+    uint32_t GetVersion() const
+    {
+        return m_version;
+    }
+    
+private:
+    std::string m_text;
+    std::weak_ptr<BitmapFont> m_font;
+    float m_fontSize = 8.0F;
+    
+    uint32_t m_version = 1;
 };
 
 struct BoxColliderComponent
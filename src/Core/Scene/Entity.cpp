@@ -29,13 +29,23 @@ void Entity::OnGUIDraw()
         transform.Size.y
     };
     
-    ImGui::InputFloat2("Transform", position);
-    ImGui::InputFloat("Rotation", &rotation);
-    ImGui::InputFloat2("Size", size);
+    bool changed = false;
     
-    transform.Position = glm::vec2(position[0], position[1]);
-    transform.Rotation = rotation;
-    transform.Size = glm::vec2(size[0], size[1]);
+    changed |= ImGui::InputFloat2("Transform", position);
+    changed |= ImGui::InputFloat("Rotation", &rotation);
+    changed |= ImGui::InputFloat2("Size", size);
+    
+    if (!changed)
+    {
+        return;
+    }
+    
+    PatchComponent<TransformComponent>([&](TransformComponent& t)
+    {
+        t.Position = glm::vec2(position[0], position[1]);
+        t.Rotation = rotation;
+        t.Size = glm::vec2(size[0], size[1]);
+    });
 }
 
 void Entity::OnUpdate(float deltaTime)
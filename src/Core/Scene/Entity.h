@@ -42,6 +42,16 @@ public:
         return m_scene->GetRegistry().get<T>(m_handle);
     }
     
+    // Modifies a component in place and notifies on_update listeners
+    template<typename T, typename Func>
+    T& PatchComponent(Func&& func)
+    {
+        return m_scene->GetRegistry().patch<T>(
+            m_handle,
+            std::forward<Func>(func)
+        );
+    }
+    
     template<typename T>
     bool HasComponent()
     {
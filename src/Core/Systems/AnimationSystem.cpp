@@ -0,0 +1,34 @@
+#include "AnimationSystem.h"
+#include "Core/AnimationClock.h"
+
+#include <algorithm>
+
+AnimationSystem::AnimationSystem(const std::shared_ptr<Scene>& scene)
+{
+    m_scene = scene;
+}
+
+void AnimationSystem::Update()
+{
+    auto scene = m_scene.lock();
+    auto view = scene->GetRegistry().view<FlipbookComponent>();
+
+    double time = AnimationClock::GetTime();
+
+    // A single component view walks the packed component array
+    for (auto [entity, flipbook] : view.each())
+    {
+        // Started after a clock reset, hold the first frame
+        double elapsed = std::max(time - flipbook.StartTime, 0.0);
+        int frame = (int)(elapsed / (double)flipbook.FrameDuration);
+
+        flipbook.Frame = frame % flipbook.Divisions;
+    }
+
+    m_animatedCount = (int)view.size();
+}
+
+int AnimationSystem::GetAnimatedCount() const
+{
+    return m_animatedCount;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Core/Scene/Components.h"
+#include "Core/Scene/Scene.h"
+
+#include <memory>
+
+// Picks the frame of every flipbook from the AnimationClock in one
+// pass over the packed FlipbookComponent storage. The Renderer only
+// reads the result.
+class AnimationSystem
+{
+public:
+    AnimationSystem(const std::shared_ptr<Scene>& scene);
+
+    void Update();
+
+    [[nodiscard]]
+    int GetAnimatedCount() const;
+
+private:
+    std::weak_ptr<Scene> m_scene;
+    int m_animatedCount = 0;
+};
@@ -0,0 +1,167 @@
+#include "RenderQueue.h"
+#include "Core/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+void NameRanks::Clear()
+{
+    m_names.clear();
+}
+
+void NameRanks::Add(unsigned int name)
+{
+    m_names.push_back(name);
+}
+
+void NameRanks::Build()
+{
+    std::sort(m_names.begin(), m_names.end());
+    m_names.erase(
+        std::unique(m_names.begin(), m_names.end()),
+        m_names.end()
+    );
+}
+
+uint32_t NameRanks::Get(unsigned int name) const
+{
+    return (uint32_t)(std::lower_bound(
+        m_names.begin(),
+        m_names.end(),
+        name) - m_names.begin());
+}
+
+size_t NameRanks::GetSize() const
+{
+    return m_names.size();
+}
+
+uint64_t RenderQueue::MakeKey(
+    uint8_t layer,
+    uint32_t shaderRank,
+    uint32_t textureRank,
+    float depth)
+{
+    // More names in a frame than the key has room for. The rest share
+    // the last value, still drawn right but sorted by depth together.
+    if (shaderRank >= RENDER_QUEUE_MAX_SHADERS ||
+        textureRank >= RENDER_QUEUE_MAX_TEXTURES)
+    {
+        static bool warned = false;
+
+        if (!warned)
+        {
+            Log::Warning(
+                "[RenderQueue] Over %d shaders or %d textures in a frame, sort keys collide",
+                RENDER_QUEUE_MAX_SHADERS,
+                RENDER_QUEUE_MAX_TEXTURES
+            );
+            warned = true;
+        }
+
+        shaderRank = std::min(shaderRank, (uint32_t)RENDER_QUEUE_MAX_SHADERS - 1);
+        textureRank = std::min(textureRank, (uint32_t)RENDER_QUEUE_MAX_TEXTURES - 1);
+    }
+
+    // Map the float onto an unsigned integer with the same ordering
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+    depthBits ^= (depthBits & 0x80000000U) ? 0xFFFFFFFFU : 0x80000000U;
+
+    return ((uint64_t)layer << 56) |
+           ((uint64_t)shaderRank << 48) |
+           ((uint64_t)textureRank << 32) |
+           (uint64_t)depthBits;
+}
+
+void RenderQueue::Clear()
+{
+    m_items.clear();
+}
+
+void RenderQueue::Submit(uint64_t key, uint32_t payload)
+{
+    m_items.push_back({ key, payload });
+}
+
+bool RenderQueue::Sort()
+{
+    // Items submitted in last frame's order are usually still sorted,
+    // in which case there is nothing left to do
+    bool sorted = true;
+
+    for (size_t i = 1; i < m_items.size(); i++)
+    {
+        if (m_items[i - 1].Key > m_items[i].Key)
+        {
+            sorted = false;
+            break;
+        }
+    }
+
+    if (sorted)
+    {
+        return false;
+    }
+
+    RadixSort();
+    return true;
+}
+
+const std::vector<RenderQueue::Item>& RenderQueue::GetItems() const
+{
+    return m_items;
+}
+
+size_t RenderQueue::GetSize() const
+{
+    return m_items.size();
+}
+
+void RenderQueue::RadixSort()
+{
+    // LSD radix sort, 8 bits per pass (stable, so equal keys
+    // keep their submission order)
+    constexpr int passes = sizeof(uint64_t);
+
+    uint32_t histograms[passes][256] = {};
+
+    for (const Item& item : m_items)
+    {
+        for (int pass = 0; pass < passes; pass++)
+        {
+            histograms[pass][(item.Key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    m_scratch.resize(m_items.size());
+
+    for (int pass = 0; pass < passes; pass++)
+    {
+        uint32_t* histogram = histograms[pass];
+
+        // Skip passes where every key shares the same byte
+        if (histogram[(m_items[0].Key >> (pass * 8)) & 0xFF] ==
+            m_items.size())
+        {
+            continue;
+        }
+
+        // Prefix sum into bucket offsets
+        uint32_t offset = 0;
+
+        for (int bucket = 0; bucket < 256; bucket++)
+        {
+            uint32_t count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += count;
+        }
+
+        for (const Item& item : m_items)
+        {
+            m_scratch[histogram[(item.Key >> (pass * 8)) & 0xFF]++] = item;
+        }
+
+        m_items.swap(m_scratch);
+    }
+}
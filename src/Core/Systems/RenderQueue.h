@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define RENDER_QUEUE_MAX_SHADERS    256
+#define RENDER_QUEUE_MAX_TEXTURES   65536
+
+// Dense per-frame indices for GL names, which are sparse and would not
+// fit the key. Ranked in name order, so keys sort as the names would.
+class NameRanks
+{
+public:
+    void Clear();
+    void Add(unsigned int name);
+
+    // Once every name of the frame was added
+    void Build();
+
+    [[nodiscard]]
+    uint32_t Get(unsigned int name) const;
+    [[nodiscard]]
+    size_t GetSize() const;
+
+private:
+    std::vector<unsigned int> m_names;
+};
+
+// Sort-key based draw queue. Each submitted item carries a 64-bit key
+// packed as [layer:8][shader:8][texture:16][depth:32], so sorting by key
+// yields a deterministic draw order that also groups state changes.
+class RenderQueue
+{
+public:
+    struct Item
+    {
+        uint64_t Key = 0;
+        uint32_t Payload = 0;
+    };
+
+    // Takes NameRanks indices, not GL names
+    static uint64_t MakeKey(
+        uint8_t layer,
+        uint32_t shaderRank,
+        uint32_t textureRank,
+        float depth
+    );
+
+    void Clear();
+    void Submit(uint64_t key, uint32_t payload);
+
+    // Returns false if the items were already in key order
+    // and no sorting work was done
+    bool Sort();
+
+    [[nodiscard]]
+    const std::vector<Item>& GetItems() const;
+    [[nodiscard]]
+    size_t GetSize() const;
+
+private:
+    void RadixSort();
+
+    std::vector<Item> m_items;
+    std::vector<Item> m_scratch;
+};
@@ -1,17 +1,22 @@
 #include "Renderer.h"
 #include "Core/Scene/Components.h"
 #include "IO/ResourceManager.h"
-#include "Rendering/Debug/DebugShapes.h"
 #include "Rendering/Font/BitmapFont.h"
+#include "Rendering/GLState.h"
 #include "Core/Log.h"
 
 #include <entt/entt.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
 
 Renderer::Renderer(const std::shared_ptr<Scene> &scene)
 {
     m_scene = scene;
     
     SetupRenderQuad();
+    SetupTextVAO();
     
     m_spriteShader = ResourceManager::LoadShader(
         "res/shaders/sprite.vert",
@@ -24,274 +29,434 @@ Renderer::Renderer(const std::shared_ptr<Scene> &scene)
         "res/shaders/font.frag",
         "FontShader"
     );
+    
+    // Resolve hot uniforms once
+    auto spriteShader = m_spriteShader.lock();
+    m_spriteImageUniform = spriteShader->GetUniform<int>("image");
+    
+    auto fontShader = m_fontShader.lock();
+    m_fontTextureUniform = fontShader->GetUniform<int>("text");
+    
+    // Invalidate the cached draw order whenever sprites come and go
+    auto& registry = scene->GetRegistry();
+    
+    registry.on_construct<SpriteRendererComponent>()
+        .connect<&Renderer::OnSpriteConstructed>(*this);
+    registry.on_destroy<SpriteRendererComponent>()
+        .connect<&Renderer::OnSpriteDestroyed>(*this);
+    registry.on_destroy<TransformComponent>()
+        .connect<&Renderer::OnSpriteDestroyed>(*this);
+    
+    // Pick up sprites created before the renderer
+    for (entt::entity entity : registry.view<SpriteRendererComponent>())
+    {
+        m_pendingGridInserts.emplace_back(entity);
+    }
 }
 
 Renderer::~Renderer()
 {
+    if (auto scene = m_scene.lock())
+    {
+        scene->GetRegistry().on_construct<SpriteRendererComponent>()
+            .disconnect(*this);
+        scene->GetRegistry().on_destroy<SpriteRendererComponent>()
+            .disconnect(*this);
+        scene->GetRegistry().on_destroy<TransformComponent>()
+            .disconnect(*this);
+    }
+    
     DestroyRenderQuad();
 }
 
-void Renderer::RenderSprites(const std::shared_ptr<Camera>& camera)
+void Renderer::UpdateSpatialGrid(const std::vector<entt::entity>& moved)
 {
-    auto shader = m_spriteShader.lock();
-    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
-    
-    // Render every component in scene with the required data
     auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
     
-    auto view = scene->GetRegistry().view<
-        const TransformComponent,
-        const SpriteRendererComponent
-    >();
-    
-    for (const auto& [entity, transform, spriteRenderer] : view.each())
+    auto update = [&](entt::entity entity)
     {
-        auto modelMatrix = glm::mat4(1.0F);
-        
-        glm::vec2 offset = transform.Pivot * transform.Size;
-        
-        // Translation
-        modelMatrix = glm::translate(
-            modelMatrix,
-            glm::vec3(
-                transform.Position,
-                0.0F
-            ));
-        
-        // Reset pivot
-        modelMatrix = glm::translate(
-            modelMatrix,
-            glm::vec3(
-                offset,
-                0.0F
-            ));
-        
-        // Rotation
-        modelMatrix = glm::rotate(
-            modelMatrix,
-            transform.Rotation,
-            glm::vec3(0.0F, 0.0F, 1.0F)
-        );
-        
-        // Flipping
-        if (spriteRenderer.FlipHorizontal)
-        {
-            modelMatrix = glm::rotate(
-                modelMatrix,
-                glm::radians(180.0F),
-                glm::vec3(0.0F, 1.0F, 0.0F)
-            );
-        }
-        
-        if (spriteRenderer.FlipVertical)
+        if (!registry.valid(entity) ||
+            !registry.all_of<
+                SpriteRendererComponent,
+                WorldTransformComponent>(entity))
         {
-            modelMatrix = glm::rotate(
-                modelMatrix,
-                glm::radians(180.0F),
-                glm::vec3(1.0F, 0.0F, 0.0F)
-            );
+            return;
         }
         
-        if (spriteRenderer.FlipDiagonal)
-        {
-            modelMatrix = glm::rotate(
-                modelMatrix,
-                glm::radians(180.0F),
-                glm::vec3(0.71F, 0.71F, 0.0F)
-            );
-        }
-        
-        // Set pivot point
-        modelMatrix = glm::translate(
-            modelMatrix,
-            glm::vec3(-offset, 0.0F)
+        m_grid.Update(
+            entity,
+            registry.get<WorldTransformComponent>(entity)
+                .Model.GetQuadBounds()
         );
+    };
+    
+    for (entt::entity entity : m_pendingGridInserts)
+    {
+        update(entity);
+    }
+    
+    m_pendingGridInserts.clear();
+    
+    for (entt::entity entity : moved)
+    {
+        update(entity);
+    }
+}
+
+void Renderer::RenderSprites(
+    const std::shared_ptr<Camera>& camera,
+    CommandList& commands)
+{
+    auto shader = m_spriteShader.lock();
+    
+    // Render every sprite overlapping the camera
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+    
+    m_visible.clear();
+    m_grid.Query(camera->GetWorldBounds(), m_visible);
+    
+    m_stats.VisibleSprites += (int)m_visible.size();
+    m_stats.TotalSprites += (int)m_grid.GetSize();
+    
+    BuildRenderQueue(registry, shader->ID);
+    
+    m_batches.clear();
+    
+    if (m_drawOrder.empty())
+    {
+        return;
+    }
+    
+    // Instances are written straight into the command list and
+    // streamed on replay, aligned to the instance size
+    auto* instances = (SpriteInstance*)commands.StreamData(
+        m_drawOrder.size() * sizeof(SpriteInstance),
+        sizeof(SpriteInstance)
+    );
+    unsigned int instanceCount = 0;
+    
+    // Gather instance data in key order, batching runs
+    // of sprites that share a texture
+    for (entt::entity entity : m_drawOrder)
+    {
+        const auto& world = registry.get<WorldTransformComponent>(entity);
+        const auto& spriteRenderer =
+            registry.get<SpriteRendererComponent>(entity);
         
-        // Sizing
-        modelMatrix = glm::scale(
-            modelMatrix,
-            glm::vec3(transform.Size, 1.0F)
-        );
-        
-        shader->Use();
-        
-        if (scene->GetRegistry().all_of<
+        if (registry.all_of<
             FlipbookComponent,
             TileComponent>(entity))
         {
             Log::Critical(
                 "Entity '%s' cannot have both a FlipbookComponent"
                 "and a TileComponent!",
-                scene->GetRegistry().get<NameComponent>(
+                registry.get<NameComponent>(
                     entity).Name.c_str()
             );
         }
         
+        // Flips are applied to texture coordinates in sprite.frag
+        int flipFlags =
+            (spriteRenderer.FlipHorizontal ? SPRITE_FLIP_HORIZONTAL : 0) |
+            (spriteRenderer.FlipVertical ? SPRITE_FLIP_VERTICAL : 0) |
+            (spriteRenderer.FlipDiagonal ? SPRITE_FLIP_DIAGONAL : 0);
+        
+        SpriteInstance instance = {};
+        instance.Linear = glm::vec4(
+            world.Model.A,
+            world.Model.B,
+            world.Model.C,
+            world.Model.D
+        );
+        instance.Translation = glm::vec2(world.Model.TX, world.Model.TY);
+        instance.Color = spriteRenderer.ColorTint;
+        instance.Frame = glm::ivec4(1, 1, 0, flipFlags);
+        instance.UVRect = spriteRenderer.GetUVRect();
+        
         // Set animation frame (if needed)
-        if (scene->GetRegistry().any_of<FlipbookComponent>(entity))
+        if (auto* flipbook = registry.try_get<FlipbookComponent>(entity))
         {
-            auto& flipbook = scene->GetRegistry()
-                .get<FlipbookComponent>(entity);
-            
-            int frame = (int)(
-                flipbook.GetCurrentTime() /
-                flipbook.FrameDuration) %
-                flipbook.Divisions;
-            
-            shader->SetInt("xDivisions", flipbook.Divisions);
-            shader->SetInt("frame", frame);
+            instance.Frame = glm::ivec4(
+                flipbook->Divisions,
+                1,
+                flipbook->Frame,
+                flipFlags
+            );
         }
-        else if (scene->GetRegistry().any_of<TileComponent>(entity))
+        else if (registry.any_of<TileComponent>(entity))
         {
-            auto& tile = scene->GetRegistry()
-                .get<TileComponent>(entity);
+            auto& tile = registry.get<TileComponent>(entity);
             
-            shader->SetInt("xDivisions", tile.Divisions.x);
-            shader->SetInt("yDivisions", tile.Divisions.y);
-            shader->SetInt("frame", tile.TileIndex);
-        }
-        else
-        {
-            shader->SetInt("xDivisions", 1);
-            shader->SetInt("yDivisions", 1);
-            shader->SetInt("frame", 0);
+            instance.Frame = glm::ivec4(
+                tile.Divisions.x,
+                tile.Divisions.y,
+                tile.TileIndex,
+                flipFlags
+            );
         }
         
-        // Shader setup
-        shader->SetMat4("model", modelMatrix);
-        shader->SetVec3("spriteColor", spriteRenderer.ColorTint);
-        shader->SetMat4("projection", camera->GetProjection());
+        unsigned int textureID = 0;
         
         if (spriteRenderer.HasTexture())
         {
-            shader->SetInt("image", 0);
-            glActiveTexture(GL_TEXTURE0);
+            textureID = spriteRenderer.GetTexture().lock()->ID;
+        }
+        
+        if (m_batches.empty() ||
+            m_batches.back().TextureID != textureID)
+        {
+            SpriteBatch batch = {};
+            batch.TextureID = textureID;
+            batch.First = instanceCount;
             
-            auto texture = spriteRenderer.GetTexture().lock();
-            texture->Bind();
+            m_batches.emplace_back(batch);
         }
         
-        // Bind VAO and draw geometry
-        glBindVertexArray(m_quadVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        m_batches.back().Count += 1;
+        instances[instanceCount++] = instance;
+    }
+    
+    // Shader setup
+    commands.UseProgram(shader->ID);
+    commands.SetUniform(m_spriteImageUniform, 0);
+    
+    commands.BindVertexArray(m_quadVAO);
+    commands.BindStreamVertexBuffer(
+        SPRITE_INSTANCE_BINDING,
+        sizeof(SpriteInstance)
+    );
+    
+    // One instanced draw per batch
+    for (const SpriteBatch& batch : m_batches)
+    {
+        commands.BindTexture(0, batch.TextureID);
+        
+        commands.DrawArraysInstanced(
+            GL_TRIANGLES,
+            0,
+            6,
+            (int)batch.Count,
+            batch.First
+        );
+        
+        m_stats.DrawCalls += 1;
+        m_stats.BatchCount += 1;
+    }
+    
+    m_stats.SpriteCount += (int)instanceCount;
+}
+
+void Renderer::BuildRenderQueue(
+    entt::registry& registry,
+    unsigned int shaderID)
+{
+    m_queue.Clear();
+    m_submitted.clear();
+    m_submittedTextures.clear();
+    m_shaderRanks.Clear();
+    m_textureRanks.Clear();
+    
+    m_shaderRanks.Add(shaderID);
+    m_shaderRanks.Build();
+    
+    auto gather = [&](entt::entity entity)
+    {
+        const auto& spriteRenderer =
+            registry.get<SpriteRendererComponent>(entity);
         
-        // Un-bind VAO
-        glBindVertexArray(0);
+        unsigned int textureID = 0;
         
-        // Draw collision if needed
-        if (scene->GetRegistry().any_of<BoxColliderComponent>(entity))
+        if (spriteRenderer.HasTexture())
         {
-            auto& collider = scene->GetRegistry()
-                .get<BoxColliderComponent>(entity);
-            
-            if (collider.DrawDebugCollision)
-            {
-                glm::vec2 worldOrigin = transform.Position +
-                    transform.Size * transform.Pivot +
-                    collider.Position;
-                glm::vec2 worldSize = transform.Size *
-                    collider.Size;
-                
-                std::vector<glm::vec2> boxPoints;
-                boxPoints.reserve(5);
-                
-                boxPoints.emplace_back(
-                    worldOrigin.x - worldSize.x * 0.5F,
-                    worldOrigin.y - worldSize.y * 0.5F
-                );
-                boxPoints.emplace_back(
-                    worldOrigin.x - worldSize.x * 0.5F,
-                    worldOrigin.y + worldSize.y * 0.5F
-                );
-                boxPoints.emplace_back(
-                    worldOrigin.x + worldSize.x * 0.5F,
-                    worldOrigin.y + worldSize.y * 0.5F
-                );
-                boxPoints.emplace_back(
-                    worldOrigin.x + worldSize.x * 0.5F,
-                    worldOrigin.y - worldSize.y * 0.5F
-                );
-                boxPoints.emplace_back(
-                    worldOrigin.x - worldSize.x * 0.5F,
-                    worldOrigin.y - worldSize.y * 0.5F
-                );
-                
-                DebugShapes::DrawLine(boxPoints, camera);
-            }
+            textureID = spriteRenderer.GetTexture().lock()->ID;
         }
+        
+        m_textureRanks.Add(textureID);
+        m_submitted.emplace_back(entity);
+        m_submittedTextures.emplace_back(textureID);
+    };
+    
+    // Last frame's order is still sorted unless a key changed,
+    // as long as the same sprites are on screen
+    bool sameSprites = !m_drawOrderDirty &&
+        m_drawOrder.size() == m_visible.size() &&
+        std::all_of(
+            m_drawOrder.begin(),
+            m_drawOrder.end(),
+            [&](entt::entity entity)
+            {
+                return m_grid.InLastQuery(entity);
+            });
+    
+    for (entt::entity entity : sameSprites ? m_drawOrder : m_visible)
+    {
+        gather(entity);
+    }
+    
+    // GL names don't fit the key, their ranks this frame do
+    m_textureRanks.Build();
+    uint32_t shaderRank = m_shaderRanks.Get(shaderID);
+    
+    for (size_t i = 0; i < m_submitted.size(); i++)
+    {
+        const auto& spriteRenderer =
+            registry.get<SpriteRendererComponent>(m_submitted[i]);
+        
+        uint64_t key = RenderQueue::MakeKey(
+            spriteRenderer.Layer,
+            shaderRank,
+            m_textureRanks.Get(m_submittedTextures[i]),
+            spriteRenderer.Depth
+        );
+        
+        m_queue.Submit(key, (uint32_t)i);
+    }
+    
+    if (m_queue.Sort())
+    {
+        m_stats.SortedSprites += (int)m_queue.GetSize();
+    }
+    
+    m_drawOrder.clear();
+    
+    for (const RenderQueue::Item& item : m_queue.GetItems())
+    {
+        m_drawOrder.emplace_back(m_submitted[item.Payload]);
     }
+    
+    m_drawOrderDirty = false;
+}
+
+void Renderer::OnSpriteConstructed(
+    entt::registry& registry,
+    entt::entity entity)
+{
+    m_drawOrderDirty = true;
+    m_pendingGridInserts.emplace_back(entity);
+}
+
+void Renderer::OnSpriteDestroyed(
+    entt::registry& registry,
+    entt::entity entity)
+{
+    m_drawOrderDirty = true;
+    m_grid.Remove(entity);
 }
 
-void Renderer::RenderFonts(const std::shared_ptr<Camera> &camera)
+void Renderer::RenderFonts(
+    const std::shared_ptr<Camera>& camera,
+    CommandList& commands)
 {
     auto scene = m_scene.lock();
     auto shader = m_fontShader.lock();
     
-    shader->Use();
-    shader->SetMat4("projection", camera->GetProjection());
-    
     auto view = scene->GetRegistry().view<
         const TransformComponent,
-        const FontRendererComponent
+        FontRendererComponent
     >();
     
-    for (const auto& [entity, transform, fontRenderer] : view.each())
+    // Re-layout only the texts that changed since their last
+    // draw, the rest reuse their cached mesh
+    size_t vertexCount = 0;
+    
+    for (auto [entity, transform, fontRenderer] : view.each())
     {
-        shader->SetVec3("textColor", fontRenderer.FontColor);
-        
-        glActiveTexture(GL_TEXTURE0);
-        fontRenderer.Font.lock()->BindTexture();
-        
-        shader->SetInt("text", 0);
+        auto bitmapFont = fontRenderer.GetFont().lock();
         
-        auto bitmapFont = fontRenderer.Font.lock();
-        glm::vec2 position = transform.Position;
-        
-        glBindVertexArray(bitmapFont->GetVAO());
-        
-        std::string text = fontRenderer.Text;
-        
-        // Make uppercase so it can be read by the font parser
-        std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+        if (!bitmapFont)
+        {
+            continue;
+        }
         
-        for (char& c : text)
+        if (fontRenderer.MeshVersion != fontRenderer.GetVersion())
         {
-            Character ch = bitmapFont->GetCharacter(c);
+            std::string_view text = fontRenderer.GetText();
             
-            float w = (float)ch.Size.x * fontRenderer.FontSize;
-            float h = (float)ch.Size.y * fontRenderer.FontSize;
+            fontRenderer.Mesh.resize(bitmapFont->GetTextVertexCount(text));
             
-            auto texture = bitmapFont->GetTexture();
+            int written = bitmapFont->WriteTextVertices(
+                text,
+                glm::vec2(0.0F),
+                fontRenderer.GetFontSize(),
+                fontRenderer.Mesh.data()
+            );
             
-            float u1 =   (float)ch.Bearing.x / (float)texture->Width;
-            float u2 =  ((float)ch.Bearing.x + (float)ch.Size.x)
-                       / (float)texture->Width;
-            float v1 =  ((float)ch.Bearing.y + (float)ch.Size.y)
-                       / (float)texture->Height;
-            float v2 =   (float)ch.Bearing.y / (float)texture->Height;
+            fontRenderer.Mesh.resize(written);
+            fontRenderer.MeshVersion = fontRenderer.GetVersion();
             
-            float vertices[6][4] =
-            {
-                { position.x,     position.y + h,   u1, v1 },
-                { position.x,     position.y,       u1, v2 },
-                { position.x + w, position.y,       u2, v2 },
-                
-                { position.x,     position.y + h,   u1, v1 },
-                { position.x + w, position.y,       u2, v2 },
-                { position.x + w, position.y + h,   u2, v1 }
-            };
+            m_stats.RebuiltTexts += 1;
+        }
+        
+        vertexCount += fontRenderer.Mesh.size();
+    }
+    
+    if (vertexCount == 0)
+    {
+        return;
+    }
+    
+    // All text shares one allocation, placed and tinted per vertex
+    auto* vertices = (TextVertex*)commands.StreamData(
+        vertexCount * sizeof(TextVertex),
+        sizeof(TextVertex)
+    );
+    unsigned int written = 0;
+    
+    m_textBatches.clear();
+    
+    for (const auto& [entity, transform, fontRenderer] : view.each())
+    {
+        auto bitmapFont = fontRenderer.GetFont().lock();
+        
+        if (!bitmapFont || fontRenderer.Mesh.empty())
+        {
+            continue;
+        }
+        
+        unsigned int textureID = bitmapFont->GetTexture()->ID;
+        uint32_t color = glm::packUnorm4x8(fontRenderer.FontColor);
+        
+        // Fonts packed into the same atlas page share a draw
+        if (m_textBatches.empty() ||
+            m_textBatches.back().TextureID != textureID)
+        {
+            SpriteBatch batch = {};
+            batch.TextureID = textureID;
+            batch.First = written;
             
-            glBindBuffer(GL_ARRAY_BUFFER, bitmapFont->GetVBO());
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+            m_textBatches.emplace_back(batch);
+        }
+        
+        for (const glm::vec4& vertex : fontRenderer.Mesh)
+        {
+            TextVertex& out = vertices[written++];
             
-            position.x += ((float)ch.Size.x + (float)ch.Advance) *
-                fontRenderer.FontSize;
+            out.Position = glm::vec2(vertex) + transform.Position;
+            out.TexCoords = glm::vec2(vertex.z, vertex.w);
+            out.Color = color;
         }
         
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        m_textBatches.back().Count += (unsigned int)fontRenderer.Mesh.size();
+    }
+    
+    commands.UseProgram(shader->ID);
+    commands.SetUniform(m_fontTextureUniform, 0);
+    
+    commands.BindVertexArray(m_textVAO);
+    commands.BindStreamVertexBuffer(0, sizeof(TextVertex));
+    
+    for (const SpriteBatch& batch : m_textBatches)
+    {
+        commands.BindTexture(0, batch.TextureID);
+        commands.DrawArrays(
+            GL_TRIANGLES,
+            (int)batch.First,
+            (int)batch.Count
+        );
+        
+        m_stats.DrawCalls += 1;
     }
 }
 
@@ -312,32 +477,118 @@ void Renderer::SetupRenderQuad()
     glGenVertexArrays(1, &m_quadVAO);
     glGenBuffers(1, &m_quadVBO);
     
-    glGenVertexArrays(1, &m_quadVAO);
-    glGenBuffers(1, &m_quadVBO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
     glBufferData(
         GL_ARRAY_BUFFER,
         sizeof(vertices),
         vertices,
         GL_STATIC_DRAW
     );
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    GLState::BindVertexArray(m_quadVAO);
+    
+    // Quad vertices (binding 0)
+    GLState::BindVertexBuffer(
+        SPRITE_QUAD_BINDING,
+        m_quadVBO,
+        0,
+        4 * sizeof(float)
+    );
     
-    glBindVertexArray(m_quadVAO);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
+    glVertexAttribFormat(0, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, SPRITE_QUAD_BINDING);
+    
+    // Per-instance attributes (binding 1), the buffer is bound
+    // to a stream buffer range every frame
+    glVertexBindingDivisor(SPRITE_INSTANCE_BINDING, 1);
+    
+    auto instanceAttribute = [](
+        unsigned int location,
+        int size,
+        GLenum type,
+        size_t offset)
+    {
+        glEnableVertexAttribArray(location);
+        
+        if (type == GL_INT)
+        {
+            glVertexAttribIFormat(location, size, type, (GLuint)offset);
+        }
+        else
+        {
+            glVertexAttribFormat(
+                location,
+                size,
+                type,
+                GL_FALSE,
+                (GLuint)offset
+            );
+        }
+        
+        glVertexAttribBinding(location, SPRITE_INSTANCE_BINDING);
+    };
+    
+    // Model affine (locations 1-2, 3-4 are unused)
+    instanceAttribute(1, 4, GL_FLOAT, offsetof(SpriteInstance, Linear));
+    instanceAttribute(2, 2, GL_FLOAT, offsetof(SpriteInstance, Translation));
+    
+    // Color tint
+    instanceAttribute(5, 4, GL_FLOAT, offsetof(SpriteInstance, Color));
+    
+    // Divisions and frame
+    instanceAttribute(6, 4, GL_INT, offsetof(SpriteInstance, Frame));
+    
+    // Atlas region
+    instanceAttribute(7, 4, GL_FLOAT, offsetof(SpriteInstance, UVRect));
+    
+    GLState::BindVertexArray(0);
+}
+
+void Renderer::SetupTextVAO()
+{
+    glGenVertexArrays(1, &m_textVAO);
+    GLState::BindVertexArray(m_textVAO);
+    
+    // Position and texture coordinates
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(
         0,
         4,
         GL_FLOAT,
         GL_FALSE,
-        4 * sizeof(float),
-        (void*)nullptr
+        offsetof(TextVertex, Position)
+    );
+    glVertexAttribBinding(0, 0);
+    
+    // Color
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(
+        1,
+        4,
+        GL_UNSIGNED_BYTE,
+        GL_TRUE,
+        offsetof(TextVertex, Color)
     );
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glVertexAttribBinding(1, 0);
+    
+    GLState::BindVertexArray(0);
 }
 
 void Renderer::DestroyRenderQuad()
 {
-    glDeleteVertexArrays(1, &m_quadVAO);
+    GLState::DeleteVertexArray(m_textVAO);
+    GLState::DeleteVertexArray(m_quadVAO);
+    GLState::DeleteBuffer(m_quadVBO);
+}
+
+void Renderer::ResetStats()
+{
+    m_stats = {};
+}
+
+const RenderStats& Renderer::GetStats() const
+{
+    return m_stats;
 }
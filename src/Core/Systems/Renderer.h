@@ -1,10 +1,38 @@
 #pragma once
 
+#include "Core/Math/Affine2D.h"
 #include "Core/Scene/Scene.h"
 #include "Rendering/Camera.h"
+#include "Rendering/CommandList.h"
 #include "Rendering/Shader.h"
+#include "RenderQueue.h"
+#include "SpatialGrid.h"
 
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
 #include <memory>
+#include <vector>
+
+// Vertex buffer binding points of the sprite VAO
+#define SPRITE_QUAD_BINDING         0
+#define SPRITE_INSTANCE_BINDING     1
+
+struct RenderStats
+{
+    int DrawCalls = 0;
+    int SpriteCount = 0;
+    int BatchCount = 0;
+
+    // Sprites that went through a full radix sort this frame
+    int SortedSprites = 0;
+    
+    // Texts whose glyph mesh was laid out again this frame
+    int RebuiltTexts = 0;
+
+    // Sprites overlapping the camera, out of all sprites
+    int VisibleSprites = 0;
+    int TotalSprites = 0;
+};
 
 class Renderer
 {
@@ -12,17 +40,112 @@ public:
     Renderer(const std::shared_ptr<Scene>& scene);
     ~Renderer();
 
-    void RenderSprites(const std::shared_ptr<Camera>& camera);
-    void RenderFonts(const std::shared_ptr<Camera>& camera);
+    // Moves sprites whose transform changed to their new grid
+    // cells, call after TransformSystem::Update()
+    void UpdateSpatialGrid(const std::vector<entt::entity>& moved);
+
+    // Record into `commands`, safe to call off the GL thread
+    void RenderSprites(
+        const std::shared_ptr<Camera>& camera,
+        CommandList& commands
+    );
+    void RenderFonts(
+        const std::shared_ptr<Camera>& camera,
+        CommandList& commands
+    );
+
+    void ResetStats();
+
+    [[nodiscard]]
+    const RenderStats& GetStats() const;
 
 private:
+    // Per-instance data read by sprite.vert, must match
+    // the attribute layout set up in SetupRenderQuad()
+    struct SpriteInstance
+    {
+        // Model affine: [A C; B D] and translation
+        glm::vec4 Linear;
+        glm::vec2 Translation;
+
+        glm::vec4 Color;
+
+        // x/y divisions, frame index and flip bits
+        glm::ivec4 Frame;
+
+        // Atlas region (min, max) the frame is picked from
+        glm::vec4 UVRect;
+    };
+
+    // Glyph vertex of the shared text batch, must match
+    // the attribute layout set up in SetupTextVAO()
+    struct TextVertex
+    {
+        glm::vec2 Position;
+        glm::vec2 TexCoords;
+        
+        // RGBA8
+        uint32_t Color;
+    };
+    
+    // Run of consecutive instances that share a texture
+    struct SpriteBatch
+    {
+        unsigned int TextureID = 0;
+        unsigned int First = 0;
+        unsigned int Count = 0;
+    };
+
     void SetupRenderQuad();
+    void SetupTextVAO();
     void DestroyRenderQuad();
-    
+
+    void BuildRenderQueue(
+        entt::registry& registry,
+        unsigned int shaderID
+    );
+    void OnSpriteConstructed(
+        entt::registry& registry,
+        entt::entity entity
+    );
+    void OnSpriteDestroyed(
+        entt::registry& registry,
+        entt::entity entity
+    );
+
     unsigned int m_quadVAO;
     unsigned int m_quadVBO;
-    
+    unsigned int m_textVAO;
+
+    RenderQueue m_queue;
+    std::vector<entt::entity> m_submitted;
+
+    // This frame's GL names as packed into the sort keys
+    NameRanks m_shaderRanks;
+    NameRanks m_textureRanks;
+    std::vector<unsigned int> m_submittedTextures;
+
+    // Sprites by world bounds, and this frame's query result
+    SpatialGrid m_grid;
+    std::vector<entt::entity> m_visible;
+
+    // New sprites, added to the grid once their transform is known
+    std::vector<entt::entity> m_pendingGridInserts;
+
+    // Sorted draw order from the previous frame
+    std::vector<entt::entity> m_drawOrder;
+    bool m_drawOrderDirty = true;
+
+    std::vector<SpriteBatch> m_batches;
+    std::vector<SpriteBatch> m_textBatches;
+
+    RenderStats m_stats;
+
     std::weak_ptr<Shader> m_spriteShader;
     std::weak_ptr<Shader> m_fontShader;
+
+    Uniform<int> m_spriteImageUniform;
+
+    Uniform<int> m_fontTextureUniform;
     std::weak_ptr<Scene> m_scene;
 };
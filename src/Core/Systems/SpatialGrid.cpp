@@ -0,0 +1,207 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_cellSize(cellSize)
+{
+}
+
+void SpatialGrid::Update(entt::entity entity, const glm::vec4& bounds)
+{
+    glm::ivec4 cells = GetCellRange(bounds);
+
+    auto it = m_entries.find(entity);
+
+    if (it == m_entries.end())
+    {
+        Entry entry = {};
+        entry.Bounds = bounds;
+        entry.Cells = cells;
+
+        m_entries.emplace(entity, entry);
+        AddToCells(entity, cells);
+
+        return;
+    }
+
+    it->second.Bounds = bounds;
+
+    // Most moves stay within the same cells
+    if (it->second.Cells == cells)
+    {
+        return;
+    }
+
+    RemoveFromCells(entity, it->second.Cells);
+    AddToCells(entity, cells);
+
+    it->second.Cells = cells;
+}
+
+void SpatialGrid::Remove(entt::entity entity)
+{
+    auto it = m_entries.find(entity);
+
+    if (it == m_entries.end())
+    {
+        return;
+    }
+
+    RemoveFromCells(entity, it->second.Cells);
+    m_entries.erase(it);
+}
+
+void SpatialGrid::Clear()
+{
+    m_cells.clear();
+    m_entries.clear();
+}
+
+void SpatialGrid::Query(
+    const glm::vec4& bounds,
+    std::vector<entt::entity>& results)
+{
+    glm::ivec4 range = GetCellRange(bounds);
+
+    m_queryStamp += 1;
+
+    auto visitCell = [&](const std::vector<entt::entity>& entities)
+    {
+        for (entt::entity entity : entities)
+        {
+            Entry& entry = m_entries[entity];
+
+            // Already seen in another cell
+            if (entry.QueryStamp == m_queryStamp)
+            {
+                continue;
+            }
+
+            entry.QueryStamp = m_queryStamp;
+
+            if (entry.Bounds.x > bounds.z ||
+                entry.Bounds.z < bounds.x ||
+                entry.Bounds.y > bounds.w ||
+                entry.Bounds.w < bounds.y)
+            {
+                continue;
+            }
+
+            entry.ResultStamp = m_queryStamp;
+            results.emplace_back(entity);
+        }
+    };
+
+    int64_t rangeSize = (int64_t)(range.z - range.x + 1) *
+        (int64_t)(range.w - range.y + 1);
+
+    // Zoomed far out, walking the occupied cells is cheaper
+    if (rangeSize > (int64_t)m_cells.size())
+    {
+        for (const auto& [key, entities] : m_cells)
+        {
+            int x = (int)(uint32_t)key;
+            int y = (int)(uint32_t)(key >> 32);
+
+            if (x >= range.x && x <= range.z &&
+                y >= range.y && y <= range.w)
+            {
+                visitCell(entities);
+            }
+        }
+
+        return;
+    }
+
+    for (int y = range.y; y <= range.w; y++)
+    {
+        for (int x = range.x; x <= range.z; x++)
+        {
+            auto cell = m_cells.find(MakeCellKey(x, y));
+
+            if (cell != m_cells.end())
+            {
+                visitCell(cell->second);
+            }
+        }
+    }
+}
+
+bool SpatialGrid::Contains(entt::entity entity) const
+{
+    return m_entries.contains(entity);
+}
+
+bool SpatialGrid::InLastQuery(entt::entity entity) const
+{
+    auto it = m_entries.find(entity);
+
+    return it != m_entries.end() &&
+        it->second.ResultStamp == m_queryStamp;
+}
+
+size_t SpatialGrid::GetSize() const
+{
+    return m_entries.size();
+}
+
+uint64_t SpatialGrid::MakeCellKey(int x, int y)
+{
+    return ((uint64_t)(uint32_t)y << 32) | (uint32_t)x;
+}
+
+glm::ivec4 SpatialGrid::GetCellRange(const glm::vec4& bounds) const
+{
+    return {
+        (int)std::floor(bounds.x / m_cellSize),
+        (int)std::floor(bounds.y / m_cellSize),
+        (int)std::floor(bounds.z / m_cellSize),
+        (int)std::floor(bounds.w / m_cellSize)
+    };
+}
+
+void SpatialGrid::AddToCells(entt::entity entity, const glm::ivec4& cells)
+{
+    for (int y = cells.y; y <= cells.w; y++)
+    {
+        for (int x = cells.x; x <= cells.z; x++)
+        {
+            m_cells[MakeCellKey(x, y)].emplace_back(entity);
+        }
+    }
+}
+
+void SpatialGrid::RemoveFromCells(
+    entt::entity entity,
+    const glm::ivec4& cells)
+{
+    for (int y = cells.y; y <= cells.w; y++)
+    {
+        for (int x = cells.x; x <= cells.z; x++)
+        {
+            auto cell = m_cells.find(MakeCellKey(x, y));
+
+            if (cell == m_cells.end())
+            {
+                continue;
+            }
+
+            auto& entities = cell->second;
+            auto it = std::find(entities.begin(), entities.end(), entity);
+
+            if (it != entities.end())
+            {
+                // Order within a cell does not matter
+                *it = entities.back();
+                entities.pop_back();
+            }
+
+            if (entities.empty())
+            {
+                m_cells.erase(cell);
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Edge length of a grid cell in world units
+#define SPATIAL_GRID_CELL_SIZE  128.0F
+
+// Uniform grid of entity bounds for visibility queries. Entities are
+// listed in every cell their bounds overlap and only move between
+// cells when their bounds cross a cell edge.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = SPATIAL_GRID_CELL_SIZE);
+
+    // Inserts or moves an entity, bounds are (min x, min y, max x, max y)
+    void Update(entt::entity entity, const glm::vec4& bounds);
+    void Remove(entt::entity entity);
+    void Clear();
+
+    // Appends every entity whose bounds overlap `bounds`, once each
+    void Query(
+        const glm::vec4& bounds,
+        std::vector<entt::entity>& results
+    );
+
+    [[nodiscard]]
+    bool Contains(entt::entity entity) const;
+
+    // Whether the last Query() returned this entity
+    [[nodiscard]]
+    bool InLastQuery(entt::entity entity) const;
+
+    [[nodiscard]]
+    size_t GetSize() const;
+
+private:
+    struct Entry
+    {
+        glm::vec4 Bounds = glm::vec4(0.0F);
+
+        // Covered cells (min x, min y, max x, max y)
+        glm::ivec4 Cells = glm::ivec4(0);
+
+        // Last query that visited / returned this entity
+        uint32_t QueryStamp = 0;
+        uint32_t ResultStamp = 0;
+    };
+
+    static uint64_t MakeCellKey(int x, int y);
+    glm::ivec4 GetCellRange(const glm::vec4& bounds) const;
+
+    void AddToCells(entt::entity entity, const glm::ivec4& cells);
+    void RemoveFromCells(entt::entity entity, const glm::ivec4& cells);
+
+    float m_cellSize;
+
+    std::unordered_map<uint64_t, std::vector<entt::entity>> m_cells;
+    std::unordered_map<entt::entity, Entry> m_entries;
+
+    uint32_t m_queryStamp = 0;
+};
@@ -0,0 +1,422 @@
+#include "TransformSystem.h"
+#include "Core/Scene/Components.h"
+#include "Core/Log.h"
+
+#include <algorithm>
+
+// Larger jumps in one tick are teleports (or snapped turns) and
+// are not interpolated
+#define INTERPOLATION_SNAP_DISTANCE     64.0F
+#define INTERPOLATION_SNAP_ROTATION     glm::radians(45.0F)
+
+TransformSystem::TransformSystem(const std::shared_ptr<Scene>& scene)
+{
+    m_scene = scene;
+
+    auto& registry = scene->GetRegistry();
+
+    registry.on_construct<TransformComponent>()
+        .connect<&TransformSystem::OnTransformConstructed>(*this);
+    registry.on_update<TransformComponent>()
+        .connect<&TransformSystem::OnTransformUpdated>(*this);
+    registry.on_destroy<TransformComponent>()
+        .connect<&TransformSystem::OnTransformDestroyed>(*this);
+
+    // Adopt entities created before the system existed
+    for (entt::entity entity : registry.view<TransformComponent>())
+    {
+        if (!registry.all_of<WorldTransformComponent>(entity))
+        {
+            OnTransformConstructed(registry, entity);
+        }
+    }
+}
+
+TransformSystem::~TransformSystem()
+{
+    if (auto scene = m_scene.lock())
+    {
+        scene->GetRegistry().on_construct<TransformComponent>()
+            .disconnect(*this);
+        scene->GetRegistry().on_update<TransformComponent>()
+            .disconnect(*this);
+        scene->GetRegistry().on_destroy<TransformComponent>()
+            .disconnect(*this);
+    }
+}
+
+void TransformSystem::BeginTick()
+{
+    auto scene = m_scene.lock();
+    auto view = scene->GetRegistry().view<
+        const TransformComponent,
+        InterpolatedTransformComponent
+    >();
+
+    for (auto [entity, transform, interpolated] : view.each())
+    {
+        interpolated.PreviousPosition = transform.Position;
+        interpolated.PreviousRotation = transform.Rotation;
+    }
+}
+
+void TransformSystem::Update(float alpha)
+{
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+
+    m_recomputedCount = 0;
+    m_updated.clear();
+
+    m_alpha = alpha;
+
+    // Entities between two different ticks move every frame, and
+    // once more to settle on the current tick when they stop
+    auto interpolatedView = registry.view<
+        const TransformComponent,
+        InterpolatedTransformComponent
+    >();
+
+    for (auto [entity, transform, interpolated] : interpolatedView.each())
+    {
+        bool moving =
+            interpolated.PreviousPosition != transform.Position ||
+            interpolated.PreviousRotation != transform.Rotation;
+
+        if (moving || interpolated.Blended)
+        {
+            MarkDirty(entity);
+        }
+
+        interpolated.Blended = moving;
+    }
+
+    ClearBatch();
+
+    for (entt::entity entity : m_dirty)
+    {
+        if (!registry.valid(entity) ||
+            !registry.all_of<WorldTransformComponent>(entity))
+        {
+            continue;
+        }
+
+        // Already rebuilt along with a dirty ancestor
+        if (!registry.get<WorldTransformComponent>(entity).Dirty)
+        {
+            continue;
+        }
+
+        // Will be rebuilt along with a dirty ancestor
+        if (HasDirtyAncestor(entity))
+        {
+            continue;
+        }
+
+        auto* hierarchy = registry.try_get<HierarchyComponent>(entity);
+
+        // Plain entities (the vast majority) go through the SIMD kernel
+        if (!hierarchy)
+        {
+            AddToBatch(entity);
+            continue;
+        }
+
+        Affine2D parentWorld = {};
+
+        if (hierarchy->Parent != entt::null)
+        {
+            parentWorld = registry.get<WorldTransformComponent>(
+                hierarchy->Parent).World;
+        }
+
+        Recompute(entity, parentWorld);
+    }
+
+    ComputeBatch();
+
+    m_dirty.clear();
+}
+
+void TransformSystem::SetParent(entt::entity child, entt::entity parent)
+{
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+
+    // Refuse to create cycles
+    for (entt::entity ancestor = parent; ancestor != entt::null;)
+    {
+        if (ancestor == child)
+        {
+            Log::Warning(
+                "[TransformSystem] Cannot parent an entity to "
+                "one of its own descendants!"
+            );
+            return;
+        }
+
+        auto* hierarchy = registry.try_get<HierarchyComponent>(ancestor);
+        ancestor = hierarchy ? hierarchy->Parent : entt::null;
+    }
+
+    auto& childHierarchy = registry.get_or_emplace<HierarchyComponent>(child);
+
+    // Detach from the previous parent
+    if (childHierarchy.Parent != entt::null)
+    {
+        auto& siblings = registry.get<HierarchyComponent>(
+            childHierarchy.Parent).Children;
+
+        siblings.erase(
+            std::remove(siblings.begin(), siblings.end(), child),
+            siblings.end()
+        );
+    }
+
+    childHierarchy.Parent = parent;
+
+    if (parent != entt::null)
+    {
+        registry.get_or_emplace<HierarchyComponent>(parent)
+            .Children.emplace_back(child);
+    }
+
+    MarkDirty(child);
+}
+
+int TransformSystem::GetRecomputedCount() const
+{
+    return m_recomputedCount;
+}
+
+const std::vector<entt::entity>& TransformSystem::GetUpdatedEntities() const
+{
+    return m_updated;
+}
+
+void TransformSystem::OnTransformConstructed(
+    entt::registry& registry,
+    entt::entity entity)
+{
+    registry.emplace_or_replace<WorldTransformComponent>(entity);
+    m_dirty.emplace_back(entity);
+}
+
+void TransformSystem::OnTransformUpdated(
+    entt::registry& registry,
+    entt::entity entity)
+{
+    MarkDirty(entity);
+}
+
+void TransformSystem::OnTransformDestroyed(
+    entt::registry& registry,
+    entt::entity entity)
+{
+    if (auto* hierarchy = registry.try_get<HierarchyComponent>(entity))
+    {
+        if (hierarchy->Parent != entt::null)
+        {
+            auto& siblings = registry.get<HierarchyComponent>(
+                hierarchy->Parent).Children;
+
+            siblings.erase(
+                std::remove(siblings.begin(), siblings.end(), entity),
+                siblings.end()
+            );
+        }
+
+        // Orphaned children fall back to world space
+        for (entt::entity child : hierarchy->Children)
+        {
+            registry.get<HierarchyComponent>(child).Parent = entt::null;
+            MarkDirty(child);
+        }
+
+        registry.remove<HierarchyComponent>(entity);
+    }
+
+    registry.remove<WorldTransformComponent>(entity);
+}
+
+TransformComponent TransformSystem::GetRenderTransform(
+    const entt::registry& registry,
+    entt::entity entity) const
+{
+    TransformComponent transform = registry.get<TransformComponent>(entity);
+
+    const auto* interpolated =
+        registry.try_get<InterpolatedTransformComponent>(entity);
+
+    if (!interpolated)
+    {
+        return transform;
+    }
+
+    glm::vec2 positionDelta = transform.Position - interpolated->PreviousPosition;
+    float rotationDelta = transform.Rotation - interpolated->PreviousRotation;
+
+    if (glm::length(positionDelta) < INTERPOLATION_SNAP_DISTANCE)
+    {
+        transform.Position =
+            interpolated->PreviousPosition + positionDelta * m_alpha;
+    }
+
+    if (glm::abs(rotationDelta) < INTERPOLATION_SNAP_ROTATION)
+    {
+        transform.Rotation =
+            interpolated->PreviousRotation + rotationDelta * m_alpha;
+    }
+
+    return transform;
+}
+
+void TransformSystem::MarkDirty(entt::entity entity)
+{
+    auto scene = m_scene.lock();
+    auto* world = scene->GetRegistry().try_get<WorldTransformComponent>(
+        entity
+    );
+
+    if (!world || world->Dirty)
+    {
+        return;
+    }
+
+    world->Dirty = true;
+    m_dirty.emplace_back(entity);
+}
+
+bool TransformSystem::HasDirtyAncestor(entt::entity entity) const
+{
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+
+    auto* hierarchy = registry.try_get<HierarchyComponent>(entity);
+
+    while (hierarchy && hierarchy->Parent != entt::null)
+    {
+        if (registry.get<WorldTransformComponent>(hierarchy->Parent).Dirty)
+        {
+            return true;
+        }
+
+        hierarchy = registry.try_get<HierarchyComponent>(hierarchy->Parent);
+    }
+
+    return false;
+}
+
+void TransformSystem::Recompute(
+    entt::entity entity,
+    const Affine2D& parentWorld)
+{
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+
+    TransformComponent transform = GetRenderTransform(registry, entity);
+    auto& world = registry.get<WorldTransformComponent>(entity);
+
+    glm::vec2 offset = transform.Pivot * transform.Size;
+
+    // Rotation around the pivot, then the same with size for the quad
+    world.World = parentWorld * Affine2D::FromTransform(
+        transform.Position,
+        glm::vec2(1.0F),
+        offset,
+        transform.Rotation
+    );
+    world.Model = parentWorld * Affine2D::FromTransform(
+        transform.Position,
+        transform.Size,
+        transform.Pivot,
+        transform.Rotation
+    );
+    world.Dirty = false;
+
+    m_recomputedCount += 1;
+    m_updated.emplace_back(entity);
+
+    // Children are relative to this entity
+    if (auto* hierarchy = registry.try_get<HierarchyComponent>(entity))
+    {
+        for (entt::entity child : hierarchy->Children)
+        {
+            Recompute(child, world.World);
+        }
+    }
+}
+
+void TransformSystem::ClearBatch()
+{
+    m_batch.Entities.clear();
+    m_batch.PositionX.clear();
+    m_batch.PositionY.clear();
+    m_batch.SizeX.clear();
+    m_batch.SizeY.clear();
+    m_batch.PivotX.clear();
+    m_batch.PivotY.clear();
+    m_batch.Rotation.clear();
+}
+
+void TransformSystem::AddToBatch(entt::entity entity)
+{
+    auto scene = m_scene.lock();
+    TransformComponent transform =
+        GetRenderTransform(scene->GetRegistry(), entity);
+
+    m_batch.Entities.emplace_back(entity);
+    m_batch.PositionX.emplace_back(transform.Position.x);
+    m_batch.PositionY.emplace_back(transform.Position.y);
+    m_batch.SizeX.emplace_back(transform.Size.x);
+    m_batch.SizeY.emplace_back(transform.Size.y);
+    m_batch.PivotX.emplace_back(transform.Pivot.x);
+    m_batch.PivotY.emplace_back(transform.Pivot.y);
+    m_batch.Rotation.emplace_back(transform.Rotation);
+}
+
+void TransformSystem::ComputeBatch()
+{
+    size_t count = m_batch.Entities.size();
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    m_batch.Models.resize(count);
+    m_batch.Worlds.resize(count);
+
+    AffineBatch batch = {};
+    batch.PositionX = m_batch.PositionX.data();
+    batch.PositionY = m_batch.PositionY.data();
+    batch.SizeX = m_batch.SizeX.data();
+    batch.SizeY = m_batch.SizeY.data();
+    batch.PivotX = m_batch.PivotX.data();
+    batch.PivotY = m_batch.PivotY.data();
+    batch.Rotation = m_batch.Rotation.data();
+    batch.Count = count;
+
+    ComputeAffines(batch, m_batch.Models.data(), m_batch.Worlds.data());
+
+    auto scene = m_scene.lock();
+    auto& registry = scene->GetRegistry();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& world = registry.get<WorldTransformComponent>(
+            m_batch.Entities[i]
+        );
+
+        world.World = m_batch.Worlds[i];
+        world.Model = m_batch.Models[i];
+        world.Dirty = false;
+    }
+
+    m_recomputedCount += (int)count;
+    m_updated.insert(
+        m_updated.end(),
+        m_batch.Entities.begin(),
+        m_batch.Entities.end()
+    );
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Core/Math/Affine2D.h"
+#include "Core/Scene/Components.h"
+#include "Core/Scene/Scene.h"
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// Keeps every entity's WorldTransformComponent in sync with its
+// TransformComponent (and its parents'). Matrices are only rebuilt
+// for transforms that were created, patched or re-parented.
+class TransformSystem
+{
+public:
+    TransformSystem(const std::shared_ptr<Scene>& scene);
+    ~TransformSystem();
+
+    // Remembers the transforms of interpolated entities before
+    // a simulation tick changes them
+    void BeginTick();
+
+    // Recomputes dirty world matrices and their descendants.
+    // Interpolated entities are placed `alpha` of the way from
+    // their previous to their current tick.
+    void Update(float alpha = 1.0F);
+
+    // Attaches `child` to `parent`, entt::null detaches it
+    void SetParent(entt::entity child, entt::entity parent);
+
+    [[nodiscard]]
+    int GetRecomputedCount() const;
+
+    // Entities whose world transform changed in the last update
+    [[nodiscard]]
+    const std::vector<entt::entity>& GetUpdatedEntities() const;
+
+private:
+    // Structure-of-arrays staging for ComputeAffines()
+    struct TransformBatch
+    {
+        std::vector<entt::entity> Entities;
+        std::vector<float> PositionX;
+        std::vector<float> PositionY;
+        std::vector<float> SizeX;
+        std::vector<float> SizeY;
+        std::vector<float> PivotX;
+        std::vector<float> PivotY;
+        std::vector<float> Rotation;
+
+        std::vector<Affine2D> Models;
+        std::vector<Affine2D> Worlds;
+    };
+
+    void OnTransformConstructed(
+        entt::registry& registry,
+        entt::entity entity
+    );
+    void OnTransformUpdated(
+        entt::registry& registry,
+        entt::entity entity
+    );
+    void OnTransformDestroyed(
+        entt::registry& registry,
+        entt::entity entity
+    );
+
+    // Transform to draw with, interpolated if the entity wants it
+    TransformComponent GetRenderTransform(
+        const entt::registry& registry,
+        entt::entity entity
+    ) const;
+
+    void MarkDirty(entt::entity entity);
+    bool HasDirtyAncestor(entt::entity entity) const;
+    void Recompute(entt::entity entity, const Affine2D& parentWorld);
+
+    void ClearBatch();
+    void AddToBatch(entt::entity entity);
+    void ComputeBatch();
+
+    std::weak_ptr<Scene> m_scene;
+
+    // Entities marked since the last update, may contain
+    // entities that have been destroyed since
+    std::vector<entt::entity> m_dirty;
+
+    TransformBatch m_batch;
+    std::vector<entt::entity> m_updated;
+
+    int m_recomputedCount = 0;
+    float m_alpha = 1.0F;
+};
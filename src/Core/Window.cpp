@@ -1,24 +1,89 @@
 #include "Window.h"
 
 #include "Log.h"
+#include "Profiler.h"
+#include "Rendering/Debug/GLTrace.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
 #include <stb_image.h>
+#include <algorithm>
+
+// From 1.92 on, NewFrame and RenderDrawData share texture updates
+// (ImDrawData::Textures), which the GL thread can't replay on its
+// own copy. vcpkg.json pins the version below that.
+static_assert(
+    IMGUI_VERSION_NUM < 19200,
+    "Threaded ImGui replay needs imgui older than 1.92"
+);
+
+// Replay GL commands on a dedicated thread. ImGui viewports are
+// disabled when on, as they need the context on the main thread.
+constexpr bool threadedRendering = true;
+
+// Measures the GL thread against in-line replay on the loaded scene
+// (see ghostGridSize and spinGhosts in Game.cpp for the stress
+// scene). Renders this many frames each way after a warm-up and logs
+// the averages. Turn verticalSync off, or both sides measure vsync.
+constexpr int renderBenchmarkFrames = 0;
+
+// The first measured frame is dropped, see UpdateRenderBenchmark
+static_assert(
+    renderBenchmarkFrames == 0 || renderBenchmarkFrames >= 2,
+    "The render benchmark needs at least 2 frames"
+);
+
+#define RENDER_BENCHMARK_WARMUP 120
+
+// The simulation runs at a fixed tick rate (see Game.cpp), so
+// rendering may run uncapped or at the monitor's refresh rate
+constexpr bool verticalSync = true;
+
+// Count GL calls through GLTrace and write them to GL_TRACE_PATH.
+// The window closes once the trace is written, so trace runs can
+// be diffed between builds.
+constexpr bool glTracing = false;
+constexpr EGLTraceMode glTraceMode = TraceSummary;
+constexpr int glTraceFrames = 300;
+
+#define GL_TRACE_PATH "gl_trace.txt"
+
+// ImGui's backend loads GL on its own, so its calls can't be
+// hooked. One draw and its buffer data per draw command.
+static void TraceImGuiDrawData(const ImDrawData* drawData)
+{
+    if (!GLTrace::IsInstalled())
+    {
+        return;
+    }
+
+    int drawCalls = 0;
+
+    for (const ImDrawList* list : drawData->CmdLists)
+    {
+        drawCalls += list->CmdBuffer.Size;
+    }
+
+    size_t bytes =
+        (size_t)drawData->TotalVtxCount * sizeof(ImDrawVert) +
+        (size_t)drawData->TotalIdxCount * sizeof(ImDrawIdx);
+
+    GLTrace::RecordExternal("ImGui draws (estimated)", drawCalls, bytes);
+}
 
 void Window::SizeChangeCallback(
     GLFWwindow* handle,
     int width,
     int height)
 {
-    glViewport(0, 0, width, height);
-
     auto windowPtr = static_cast<Window*>(
         glfwGetWindowUserPointer(handle)
     );
 
+    // Applied by the next recorded frame
+    windowPtr->m_framebufferSize = glm::ivec2(width, height);
     windowPtr->m_game->OnWindowResize(width, height);
 }
 
@@ -84,15 +149,15 @@ void Window::InitWindow(int width, int height)
         exit(1);
     }
 
-    // Using 4.3 for debugger callbacks
+    // Using 4.4 for debugger callbacks and glBufferStorage
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef _DEBUG
     glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 #endif
-    // Enable MSAA (GLFW)
-    glfwWindowHint(GLFW_SAMPLES, AA_SAMPLES);
+    // Enable MSAA (GLFW), unless the scene is upscaled
+    glfwWindowHint(GLFW_SAMPLES, NATIVE_RESOLUTION ? 0 : AA_SAMPLES);
 
     m_handle = glfwCreateWindow(
         width,
@@ -113,6 +178,12 @@ void Window::InitWindow(int width, int height)
     glfwMakeContextCurrent(m_handle);
     glfwSetWindowUserPointer(m_handle, this);
 
+    glfwGetFramebufferSize(
+        m_handle,
+        &m_framebufferSize.x,
+        &m_framebufferSize.y
+    );
+
     glfwSetFramebufferSizeCallback(
         m_handle,
         SizeChangeCallback
@@ -129,13 +200,18 @@ void Window::InitWindow(int width, int height)
         );
     }
 
+    if (glTracing)
+    {
+        GLTrace::Install(GL_TRACE_PATH, glTraceMode, glTraceFrames);
+    }
+
     // Enable debug callbacks
 #ifdef _DEBUG
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(MessageCallback, nullptr);
 #endif
 
-    glfwSwapInterval(1);
+    glfwSwapInterval(verticalSync ? 1 : 0);
 
     // Enable MSAA (glad)
     glEnable(GL_MULTISAMPLE);
@@ -169,16 +245,43 @@ void Window::WindowLoop()
     
     SetImGuiTheme();
 
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+    if (!threadedRendering)
+    {
+        io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+    }
+
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
     ImGui_ImplGlfw_InitForOpenGL(m_handle, true);
     ImGui_ImplOpenGL3_Init();
 
+    // Creates the ImGui GL objects while the context is current
+    // here. Later calls are recorded with the draw data, so they
+    // run on whichever thread replays it.
+    ImGui_ImplOpenGL3_NewFrame();
+
     // Get game pointer
     m_game = std::make_unique<Game>(this);
     m_game->Init();
 
+    // Loading is reported as a frame of its own
+    GLTrace::EndFrame();
+
+    // Takes over the context from here on
+    m_threadedRendering = threadedRendering;
+    m_renderThread = std::make_unique<RenderThread>(
+        m_handle,
+        m_threadedRendering
+    );
+
+    if (renderBenchmarkFrames > 0 && verticalSync)
+    {
+        Log::Warning(
+            "[Window] Benchmarking with vertical sync on, "
+            "frame times will be the refresh rate"
+        );
+    }
+
     auto prevTime = std::chrono::high_resolution_clock::now();
 
     while (!glfwWindowShouldClose(m_handle) &&
@@ -186,8 +289,12 @@ void Window::WindowLoop()
     {
         glfwPollEvents();
 
-        // Start ImGui frame
-        ImGui_ImplOpenGL3_NewFrame();
+        if (GLTrace::IsFinished())
+        {
+            m_shouldClose = true;
+        }
+
+        // Start ImGui frame, the GL backend's side is in RecordImGui
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
@@ -196,24 +303,45 @@ void Window::WindowLoop()
         std::chrono::duration<float> deltaTime = currentTime - prevTime;
         prevTime = currentTime;
 
+        UpdateRenderBenchmark(deltaTime.count());
+        ApplyRenderMode();
+
         // Call engine loops
-        m_game->Update(deltaTime.count());
-        m_game->RenderGUI();
-        m_game->Render();
+        Profiler::BeginFrame();
+
+        {
+            ProfileScope profile(ProfileUpdate);
+            m_game->Update(deltaTime.count());
+        }
+        {
+            ProfileScope profile(ProfileImGuiBuild);
+            m_game->RenderGUI();
+        }
+
+        CommandList& commands = m_renderThread->BeginFrame();
+
+        commands.Viewport(
+            0,
+            0,
+            m_framebufferSize.x,
+            m_framebufferSize.y
+        );
+
+        m_game->Render(commands);
 
         // Render ImGui frame
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            ProfileScope profile(commands, ProfileImGui);
 
-        // Support viewports
-        ImGui::UpdatePlatformWindows();
-        ImGui::RenderPlatformWindowsDefault();
+            ImGui::Render();
+            RecordImGui(commands);
+        }
 
         // Refresh window
-        glfwMakeContextCurrent(m_handle);
-        glfwSwapBuffers(m_handle);
+        m_renderThread->Submit();
     }
 
+    m_renderThread->Stop();
     m_game->Destroy();
 
     // Destroy ImGui context
@@ -227,6 +355,175 @@ GLFWwindow* Window::GetWindowHandle()
     return m_handle;
 }
 
+RenderThreadStats Window::GetRenderThreadStats() const
+{
+    if (!m_renderThread)
+    {
+        return {};
+    }
+
+    return m_renderThread->GetStats();
+}
+
+void Window::SetThreadedRendering(bool threaded)
+{
+    // Viewports render their windows from the main thread
+    if (threaded &&
+        ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    {
+        Log::Warning(
+            "[Window] Threaded rendering needs ImGui viewports disabled!"
+        );
+        return;
+    }
+
+    m_threadedRendering = threaded;
+}
+
+bool Window::IsThreadedRendering() const
+{
+    return m_threadedRendering;
+}
+
+void Window::ApplyRenderMode()
+{
+    if (m_renderThread->IsThreaded() == m_threadedRendering)
+    {
+        return;
+    }
+
+    // Finishes queued frames and hands the context back to this
+    // thread, where the next RenderThread picks it up
+    m_renderThread.reset();
+    m_renderThread = std::make_unique<RenderThread>(
+        m_handle,
+        m_threadedRendering
+    );
+
+    if (!m_threadedRendering)
+    {
+        Log::Info("[Window] Replaying GL commands in-line");
+    }
+}
+
+void Window::UpdateRenderBenchmark(float deltaTime)
+{
+    if (renderBenchmarkFrames <= 0 || m_benchmarkFrame < 0)
+    {
+        return;
+    }
+
+    // Threaded rendering is refused with viewports on, both phases
+    // would measure in-line
+    if (m_benchmarkFrame == 0 &&
+        ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    {
+        Log::Warning(
+            "[Window] Render benchmark skipped, it needs ImGui viewports disabled"
+        );
+
+        m_benchmarkFrame = -1;
+        return;
+    }
+
+    int phaseLength = RENDER_BENCHMARK_WARMUP + renderBenchmarkFrames;
+    int phase = m_benchmarkFrame / phaseLength;
+    int frame = m_benchmarkFrame % phaseLength;
+
+    if (phase < 2)
+    {
+        if (frame == 0)
+        {
+            SetThreadedRendering(phase == 1);
+        }
+        else if (frame > RENDER_BENCHMARK_WARMUP)
+        {
+            // deltaTime is the previous frame, the first measured
+            // one is also skipped so the mode switch isn't counted
+            m_benchmarkFrameTime[phase] += deltaTime * 1000.0;
+            m_benchmarkReplayTime[phase] +=
+                m_renderThread->GetStats().ReplayMilliseconds;
+        }
+
+        m_benchmarkFrame += 1;
+        return;
+    }
+
+    int measured = renderBenchmarkFrames - 1;
+
+    double inlineFrame = m_benchmarkFrameTime[0] / measured;
+    double threadedFrame = m_benchmarkFrameTime[1] / measured;
+
+    Log::Info(
+        "[Window] Render benchmark, %i frames each: "
+        "in-line %.3f ms/frame (%.3f ms replay), "
+        "threaded %.3f ms/frame (%.3f ms replay), %.1f%% less frame time",
+        measured,
+        inlineFrame,
+        m_benchmarkReplayTime[0] / measured,
+        threadedFrame,
+        m_benchmarkReplayTime[1] / measured,
+        (1.0 - threadedFrame / inlineFrame) * 100.0
+    );
+
+    SetThreadedRendering(threadedRendering);
+    m_benchmarkFrame = -1;
+}
+
+void Window::RecordImGui(CommandList& commands)
+{
+    if (!m_renderThread->IsThreaded())
+    {
+        // Replayed before the next ImGui frame, the draw data
+        // can be used as is
+        commands.Execute([]
+        {
+            ImGui_ImplOpenGL3_NewFrame();
+            TraceImGuiDrawData(ImGui::GetDrawData());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+            // Support viewports
+            if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+            {
+                ImGui::UpdatePlatformWindows();
+                ImGui::RenderPlatformWindowsDefault();
+            }
+        });
+
+        return;
+    }
+
+    // The next ImGui frame reuses the draw lists while this one is
+    // replayed, so the GL thread gets its own copy
+    ImDrawData* drawData = ImGui::GetDrawData();
+
+    std::shared_ptr<ImDrawData> copy(
+        new ImDrawData(*drawData),
+        [](ImDrawData* data)
+        {
+            for (ImDrawList* list : data->CmdLists)
+            {
+                IM_DELETE(list);
+            }
+
+            delete data;
+        }
+    );
+
+    for (ImDrawList*& list : copy->CmdLists)
+    {
+        list = list->CloneOutput();
+    }
+
+    // The backend's state is only touched on the GL thread
+    commands.Execute([copy]
+    {
+        ImGui_ImplOpenGL3_NewFrame();
+        TraceImGuiDrawData(copy.get());
+        ImGui_ImplOpenGL3_RenderDrawData(copy.get());
+    });
+}
+
 void Window::SetImGuiTheme()
 {
     // Set font
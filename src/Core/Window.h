@@ -8,9 +8,17 @@
 #include <chrono>
 
 #include "Game/Game.h"
+#include "Rendering/RenderThread.h"
 
 #define AA_SAMPLES      16
 
+// Draw the scene offscreen at the arcade's resolution (times the
+// scale in Game.cpp) and upscale it to the window. The window is
+// then single sampled, as blits can't write to multisampled ones.
+#define NATIVE_RESOLUTION   1
+#define NATIVE_WIDTH        224
+#define NATIVE_HEIGHT       288
+
 class Window
 {
 public:
@@ -45,6 +53,15 @@ public:
 
     GLFWwindow* GetWindowHandle();
 
+    [[nodiscard]]
+    RenderThreadStats GetRenderThreadStats() const;
+
+    // Switches between the GL thread and in-line replay before the
+    // next frame. Not possible while ImGui viewports are enabled.
+    void SetThreadedRendering(bool threaded);
+    [[nodiscard]]
+    bool IsThreadedRendering() const;
+
 protected:
     std::unique_ptr<Game> m_game;
 
@@ -52,6 +69,25 @@ private:
     void SetWindowIcon();
     void SetImGuiTheme();
 
+    // Queues this frame's ImGui draw data for replay
+    void RecordImGui(CommandList& commands);
+
+    // Replaces the RenderThread if SetThreadedRendering() asked to
+    void ApplyRenderMode();
+
+    // Steps the measurement enabled by renderBenchmarkFrames
+    void UpdateRenderBenchmark(float deltaTime);
+
     GLFWwindow* m_handle;
     bool m_shouldClose = false;
+
+    glm::ivec2 m_framebufferSize = { 0, 0 };
+
+    std::unique_ptr<RenderThread> m_renderThread;
+    bool m_threadedRendering = true;
+
+    // In-line, then threaded
+    int m_benchmarkFrame = 0;
+    double m_benchmarkFrameTime[2] = {};
+    double m_benchmarkReplayTime[2] = {};
 };
\ No newline at end of file
@@ -10,36 +10,38 @@
 
 void Pacman::OnKeyPressed(int key)
 {
-    auto& transform = m_entity.GetComponent<TransformComponent>();
-    
-    if (key == GLFW_KEY_UP || key == GLFW_KEY_W)
-    {
-        m_input.x = 0.0F;
-        m_input.y = -1.0F;
-        
-        transform.SetRotation(-90.0F);
-    }
-    if (key == GLFW_KEY_DOWN || key == GLFW_KEY_S)
-    {
-        m_input.x = 0.0F;
-        m_input.y = 1.0F;
-        
-        transform.SetRotation(90.0F);
-    }
-    if (key == GLFW_KEY_LEFT || key == GLFW_KEY_A)
-    {
-        m_input.x = -1.0F;
-        m_input.y = 0.0F;
-        
-        transform.SetRotation(-180.0F);
-    }
-    if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_D)
+    m_entity.PatchComponent<TransformComponent>([&](
+        TransformComponent& transform)
     {
-        m_input.x = 1.0F;
-        m_input.y = 0.0F;
-        
-        transform.SetRotation(0.0F);
-    }
+        if (key == GLFW_KEY_UP || key == GLFW_KEY_W)
+        {
+            m_input.x = 0.0F;
+            m_input.y = -1.0F;
+            
+            transform.SetRotation(-90.0F);
+        }
+        if (key == GLFW_KEY_DOWN || key == GLFW_KEY_S)
+        {
+            m_input.x = 0.0F;
+            m_input.y = 1.0F;
+            
+            transform.SetRotation(90.0F);
+        }
+        if (key == GLFW_KEY_LEFT || key == GLFW_KEY_A)
+        {
+            m_input.x = -1.0F;
+            m_input.y = 0.0F;
+            
+            transform.SetRotation(-180.0F);
+        }
+        if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_D)
+        {
+            m_input.x = 1.0F;
+            m_input.y = 0.0F;
+            
+            transform.SetRotation(0.0F);
+        }
+    });
 }
 
 void Pacman::OnKeyReleased(int key)
@@ -56,13 +58,22 @@ Pacman::Pacman(const std::shared_ptr<Scene>& scene)
     transform.Position = glm::vec2(PACMAN_POSITION);
     transform.Size = glm::vec2(PACMAN_SIZE);
     
-    auto pacmanTex = ResourceManager::LoadTexture(
-        "res/sprites/pacman.png",
-        "Pacman"
-    );
+    // Moves every tick, drawn smoothly in between
+    m_entity.AddComponent<InterpolatedTransformComponent>();
+    
+    // Prefer the atlas copy if the game already packed it
+    auto pacmanTex = ResourceManager::GetTexture("Pacman");
+    
+    if (!pacmanTex)
+    {
+        pacmanTex = ResourceManager::LoadTexture(
+            "res/sprites/pacman.png",
+            "Pacman"
+        );
+    }
     
     m_entity.AddComponent<SpriteRendererComponent>(
-        pacmanTex,
+        ResourceManager::GetTextureRegion(pacmanTex),
         glm::vec4(1.0F)
     );
     m_entity.AddComponent<FlipbookComponent>(3, PACMAN_ANIM_FRAME_TIME);
@@ -73,6 +84,14 @@ Pacman::Pacman(const std::shared_ptr<Scene>& scene)
 
 void Pacman::OnUpdate(float deltaTime)
 {
-    auto& transform = m_entity.GetComponent<TransformComponent>();
-    transform.Position += m_input * PACMAN_MOVE_SPEED * deltaTime;
+    if (m_input == glm::vec2(0.0F))
+    {
+        return;
+    }
+    
+    m_entity.PatchComponent<TransformComponent>([&](
+        TransformComponent& transform)
+    {
+        transform.Position += m_input * PACMAN_MOVE_SPEED * deltaTime;
+    });
 }
@@ -2,10 +2,17 @@
 
 #include "Core/Window.h"
 #include "IO/ResourceManager.h"
+#include "IO/TextureLoader.h"
 #include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/AnimationClock.h"
 #include "Entities/Pacman.h"
 #include "Rendering/Font/BitmapFont.h"
 #include "Rendering/Debug/DebugShapes.h"
+#include "Rendering/StreamBuffer.h"
+#include "Rendering/ShaderCache.h"
+#include "Rendering/GLState.h"
+#include "Rendering/Debug/GLTrace.h"
 #include "Core/Scene/Entity.h"
 #include "Core/Scene/Scene.h"
 #include "Core/Scene/Components.h"
@@ -14,47 +21,166 @@
 #include <imgui.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 std::map<std::string, std::shared_ptr<Sprite>> Game::m_sprites;
 
 constexpr bool muteGame = true;
+constexpr ETilemapRenderMode tilemapRenderMode = ETilemapRenderMode::GPULayers;
+
+// Swap for a map_generator output (with ETilemapRenderMode::Chunks)
+// to benchmark large maps
+constexpr const char* tilemapPath = "res/maps/level.json";
+
+// Blinky grid size, raise (e.g. to 150) for a stress scene
+constexpr int ghostGridSize = 5;
+
+// Spins every ghost, so transforms, culling and sprite instances
+// are rebuilt each frame (stress testing update and render)
+constexpr bool spinGhosts = false;
+
+// Simulation ticks per second, independent of the frame rate.
+// The arcade machine ran its game logic at 60 Hz.
+constexpr float simulationTickRate = 60.0F;
+
+// Multiple of the arcade's resolution the scene is drawn at when
+// NATIVE_RESOLUTION is on. Only worth raising for rotated sprites.
+constexpr int nativeResolutionScale = 1;
 
 #define ROTATE_SPEED 15.0F
 
+// A slow frame runs at most this many ticks and drops the rest of
+// its time, instead of falling further behind every frame
+#define MAX_TICKS_PER_FRAME 5
+
 Game::Game(Window* window)
 {
     std::shared_ptr<Window> windowPtr(window);
     m_window = windowPtr;
     
     m_scene = std::make_shared<Scene>();
+    m_tickRate = simulationTickRate;
 }
 
 void Game::Init()
 {
     Log::Trace("Hello game!");
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // ImGui set up its own state, start from a clean slate
+    GLState::Invalidate();
+    GLState::SetBlend(true);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Camera setup
+    // Camera setup, the world is 4 units per arcade pixel
     m_camera = std::make_shared<Camera>(
         glm::vec2(0.0F),
         896,
         1152
     );
 
+    if (NATIVE_RESOLUTION)
+    {
+        m_sceneTarget = std::make_unique<RenderTarget>(
+            NATIVE_WIDTH * nativeResolutionScale,
+            NATIVE_HEIGHT * nativeResolutionScale
+        );
+    }
+
+    glm::ivec2 framebufferSize;
+    glfwGetFramebufferSize(
+        m_window->GetWindowHandle(),
+        &framebufferSize.x,
+        &framebufferSize.y
+    );
+    OnWindowResize(framebufferSize.x, framebufferSize.y);
+
+    // Per-frame shader data
+    m_frameUniforms = std::make_unique<FrameUniforms>();
+
+    // Shader programs, linked from the binary cache or compiled by
+    // the driver while the textures below decode
+    auto shaderStart = std::chrono::steady_clock::now();
+
+    ShaderCache::Init();
+    ResourceManager::QueueShader("res/shaders/sprite.vert", "res/shaders/sprite.frag", "SpriteShader");
+    ResourceManager::QueueShader("res/shaders/font.vert", "res/shaders/font.frag", "FontShader");
+    ResourceManager::QueueShader("res/shaders/tilemap.vert", "res/shaders/tilemap.frag", "TilemapShader");
+    ResourceManager::QueueShader("res/shaders/tile_chunk.vert", "res/shaders/tile_chunk.frag", "TileChunkShader");
+    ResourceManager::QueueShader("res/shaders/debug/solid_color.vert", "res/shaders/debug/solid_color.frag", "Debug");
+
+    float shaderMilliseconds = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - shaderStart).count();
+
+    // Dynamic vertex and instance data
+    StreamBuffer::Init();
+    Profiler::Init();
+    TextureLoader::Init();
+
+    // Transform setup, before any entity is created
+    m_transformSystem = std::make_unique<TransformSystem>(m_scene);
+    m_animationSystem = std::make_unique<AnimationSystem>(m_scene);
+
     // Audio emitter setup
     m_audioEmitter = std::make_shared<AudioEmitter>();
 
-    // Font entity setup
-    auto fontTex = ResourceManager::LoadTexture(
+    // Texture loading, decoded in parallel (or mapped if cooked)
+    auto textureStart = std::chrono::steady_clock::now();
+    
+    auto fontTex = ResourceManager::LoadTextureAsync(
         "res/fonts/font.png",
         "FontTexture"
     );
+    auto ghostTex = ResourceManager::LoadTextureAsync("res/sprites/ghost.png", "Blinky");
+    auto pacmanTex = ResourceManager::LoadTextureAsync("res/sprites/pacman.png", "Pacman");
+    auto mazeTex = ResourceManager::LoadTextureAsync("res/sprites/maze_tileset.png", "MazeTileset");
+    auto dotTex = ResourceManager::LoadTextureAsync("res/sprites/dots.png", "Dots");
+    
+    // Same image as the maze, shares its texture
+    auto debugTex = ResourceManager::LoadTextureAsync("res/sprites/maze_tileset.png", "DebugTileset");
+    
+    // The atlas is packed from the real pixels
+    ResourceManager::WaitForTextures({
+        fontTex,
+        ghostTex,
+        pacmanTex,
+        mazeTex,
+        dotTex,
+        debugTex
+    });
+    
+    Log::Info(
+        "[Game] Textures ready in %.2f ms",
+        std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - textureStart).count()
+    );
+    
+    // Whatever the driver has not finished yet is waited on here
+    shaderStart = std::chrono::steady_clock::now();
+    ResourceManager::FinishShaders();
+
+    shaderMilliseconds += std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - shaderStart).count();
+    ShaderCache::Report(shaderMilliseconds);
+
+    DebugShapes::Init();
+    
+    // Everything drawn by the game shares atlas pages so sprites,
+    // tiles and text can be batched under a single texture binding
+    ResourceManager::PackAtlas({
+        fontTex,
+        ghostTex,
+        pacmanTex,
+        mazeTex,
+        dotTex,
+        debugTex
+    });
+    
+    // Font entity setup
     m_font = std::make_shared<BitmapFont>();
     m_font->LoadFont(
-        fontTex,
+        ResourceManager::GetTextureRegion(fontTex),
         "res/fonts/font.json"
     );
     
@@ -75,13 +201,13 @@ void Game::Init()
     m_renderer = std::make_shared<Renderer>(m_scene);
 
     // Ghost sprite setup
-    auto ghostTex = ResourceManager::LoadTexture("res/sprites/ghost.png", "Blinky");
+    TextureRegion ghostRegion = ResourceManager::GetTextureRegion(ghostTex);
 
-    for (int i = 0; i < 5; i++)
+    for (int i = 0; i < ghostGridSize; i++)
     {
-        for (int j = 0; j < 5; j++)
+        for (int j = 0; j < ghostGridSize; j++)
         {
-            std::string name = "Blinky" + std::to_string(5 * i + j);
+            std::string name = "Blinky" + std::to_string(ghostGridSize * i + j);
             glm::vec2 pos = glm::vec2(100.0F) + (glm::vec2((float)i, (float)j) * 50.0F);
             
             Log::Info("Creating sprite %s at [%f, %f]",
@@ -94,10 +220,10 @@ void Game::Init()
             
             SpriteRendererComponent srCompData = {};
             
-            srCompData.SetTexture(ghostTex);
+            srCompData.SetTexture(ghostRegion);
             srCompData.ColorTint = glm::vec4(1.0F);
             
-            ghostEntity.AddComponent<SpriteRendererComponent>(ghostTex, glm::vec4(1.0F));
+            ghostEntity.AddComponent<SpriteRendererComponent>(ghostRegion, glm::vec4(1.0F));
             ghostEntity.AddComponent<BoxColliderComponent>().DrawDebugCollision = true;
             
             auto& t = ghostEntity.GetComponent<TransformComponent>();
@@ -105,7 +231,13 @@ void Game::Init()
             t.Position = glm::vec2(100.0F) + (glm::vec2((float)i, (float)j) * 50.0F);
             t.Size = glm::vec2(56.0F);
             
+            if (spinGhosts)
+            {
+                ghostEntity.AddComponent<InterpolatedTransformComponent>();
+            }
+            
             m_entities.emplace_back(ghostEntity);
+            m_ghosts.emplace_back(ghostEntity);
         }
     }
 
@@ -113,21 +245,17 @@ void Game::Init()
     std::vector<TilemapInput> tilemaps;
     tilemaps.reserve(3);
 
-    auto mazeTex = ResourceManager::LoadTexture("res/sprites/maze_tileset.png", "MazeTileset");
-    auto dotTex = ResourceManager::LoadTexture("res/sprites/dots.png", "MazeTileset");
-    auto debugTex = ResourceManager::LoadTexture("res/sprites/maze_tileset.png", "MazeTileset");
-
     TilemapInput mazeTilemap = {};
     mazeTilemap.Dimensions = glm::ivec2(6, 2);
-    mazeTilemap.Texture = mazeTex;
+    mazeTilemap.Region = ResourceManager::GetTextureRegion(mazeTex);
     
     TilemapInput dotTilemap = {};
     dotTilemap.Dimensions = glm::ivec2(2, 1);
-    dotTilemap.Texture = dotTex;
+    dotTilemap.Region = ResourceManager::GetTextureRegion(dotTex);
     
     TilemapInput debugTilemap = {};
     debugTilemap.Dimensions = glm::ivec2(1, 1);
-    debugTilemap.Texture = debugTex;
+    debugTilemap.Region = ResourceManager::GetTextureRegion(debugTex);
     
     tilemaps.emplace_back(mazeTilemap);
     tilemaps.emplace_back(dotTilemap);
@@ -135,9 +263,10 @@ void Game::Init()
 
     m_tileMap = std::make_shared<Tilemap>(
         m_scene,
-        "res/maps/level.json",
+        tilemapPath,
         tilemaps,
-        25
+        25,
+        tilemapRenderMode
     );
 
     // Pacman animated sprite setup
@@ -152,22 +281,140 @@ void Game::Init()
 
 void Game::Update(float deltaTime)
 {
-    m_pacman->OnUpdate(deltaTime);
+    m_deltaTime = deltaTime;
+    
+    float tickTime = 1.0F / m_tickRate;
+    float maxAccumulated = tickTime * MAX_TICKS_PER_FRAME;
+    
+    m_accumulator += deltaTime;
+    
+    if (m_accumulator > maxAccumulated)
+    {
+        m_accumulator = maxAccumulated;
+        m_clampedFrames += 1;
+    }
+    
+    m_ticksThisFrame = 0;
+    
+    while (m_accumulator >= tickTime)
+    {
+        m_transformSystem->BeginTick();
+        FixedUpdate(tickTime);
+        
+        m_accumulator -= tickTime;
+        m_ticksThisFrame += 1;
+    }
+    
+    // Rendered this far between the last two ticks
+    m_tickAlpha = m_accumulator / tickTime;
+    
+    // The clock only moves with ticks
+    if (m_ticksThisFrame > 0)
+    {
+        m_animationSystem->Update();
+    }
+}
+
+void Game::FixedUpdate(float tickTime)
+{
+    AnimationClock::Advance(tickTime);
+    
+    m_pacman->OnUpdate(tickTime);
     
     for (Entity entity : m_entities)
     {
-        entity.OnUpdate(deltaTime);
+        entity.OnUpdate(tickTime);
+    }
+    
+    if (spinGhosts)
+    {
+        for (Entity ghost : m_ghosts)
+        {
+            ghost.PatchComponent<TransformComponent>(
+                [tickTime](TransformComponent& transform)
+                {
+                    transform.Rotation += glm::radians(ROTATE_SPEED) * tickTime;
+                });
+        }
     }
 }
 
-void Game::Render()
+void Game::Render(CommandList& commands)
 {
+    // Textures decoded since the last frame, and released ones
+    TextureLoader::Update(commands);
+    ResourceManager::Update(commands);
+    
+    // The scene passes always see the same small target, the
+    // window size only matters to the upscale
+    if (m_sceneTarget)
+    {
+        glm::ivec2 sceneSize = m_sceneTarget->GetSize();
+
+        commands.BindFramebuffer(m_sceneTarget->GetFramebuffer());
+        commands.Viewport(0, 0, sceneSize.x, sceneSize.y);
+    }
+
     // Game rendering
-    glClearColor(0.0F, 0.0F, 0.0F, 1.0F);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    commands.Clear(
+        GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
+        glm::vec4(0.0F, 0.0F, 0.0F, 1.0F)
+    );
+    
+    m_frameUniforms->Update(
+        commands,
+        *m_camera,
+        (float)AnimationClock::GetTime(),
+        m_deltaTime
+    );
+    
+    m_renderer->ResetStats();
+    m_transformSystem->Update(m_tickAlpha);
+    m_renderer->UpdateSpatialGrid(m_transformSystem->GetUpdatedEntities());
     
-    m_renderer->RenderSprites(m_camera);
-    m_renderer->RenderFonts(m_camera);
+    {
+        ProfileScope profile(commands, ProfileTilemap);
+        m_tileMap->Draw(m_camera, commands);
+    }
+    {
+        ProfileScope profile(commands, ProfileSprites);
+        m_renderer->RenderSprites(m_camera, commands);
+    }
+    {
+        ProfileScope profile(commands, ProfileFonts);
+        m_renderer->RenderFonts(m_camera, commands);
+    }
+    if (m_sceneTarget)
+    {
+        ProfileScope profile(commands, ProfileUpscale);
+
+        // Letterbox bars, then the scene on top
+        commands.BindFramebuffer(0);
+        commands.Clear(GL_COLOR_BUFFER_BIT, glm::vec4(0.0F, 0.0F, 0.0F, 1.0F));
+        commands.BlitFramebuffer(
+            m_sceneTarget->GetFramebuffer(),
+            m_sceneTarget->GetSize(),
+            m_sceneRect
+        );
+
+        // Debug shapes are drawn at window resolution over it
+        commands.Viewport(
+            m_sceneRect.x,
+            m_sceneRect.y,
+            m_sceneRect.z,
+            m_sceneRect.w
+        );
+    }
+    {
+        ProfileScope profile(commands, ProfileDebug);
+        
+        if (m_showCollision)
+        {
+            DebugShapes::DrawColliders(m_scene->GetRegistry());
+        }
+        
+        DebugShapes::Flush(commands);
+    }
 }
 
 void Game::RenderGUI()
@@ -177,6 +424,159 @@ void Game::RenderGUI()
     {
         ImGui::SeparatorText("Debug Flags:");
         ImGui::Checkbox("Show Collision", &m_showCollision);
+        
+        ImGui::SeparatorText("Camera:");
+        
+        glm::vec2 cameraPosition = m_camera->GetPosition();
+        float cameraZoom = m_camera->GetZoom();
+        
+        if (ImGui::DragFloat2("Position", &cameraPosition.x, 4.0F))
+        {
+            m_camera->SetPosition(cameraPosition);
+        }
+        if (ImGui::SliderFloat("Zoom", &cameraZoom, 0.1F, 4.0F))
+        {
+            m_camera->SetZoom(cameraZoom);
+        }
+        
+        ImGui::SeparatorText("Simulation:");
+        ImGui::SliderFloat("Tick rate", &m_tickRate, 10.0F, 240.0F, "%.0f Hz");
+        ImGui::Text(
+            "Ticks this frame: %i (alpha %.2f)",
+            m_ticksThisFrame,
+            m_tickAlpha
+        );
+        ImGui::Text("Frames over the tick limit: %i", m_clampedFrames);
+        
+        ImGui::SeparatorText("Animation:");
+        
+        bool animationPaused = AnimationClock::IsPaused();
+        float animationTimeScale = AnimationClock::GetTimeScale();
+        
+        if (ImGui::Checkbox("Paused", &animationPaused))
+        {
+            AnimationClock::SetPaused(animationPaused);
+        }
+        if (ImGui::SliderFloat("Time scale", &animationTimeScale, 0.0F, 4.0F))
+        {
+            AnimationClock::SetTimeScale(animationTimeScale);
+        }
+        ImGui::Text("Clock: %.2f s", AnimationClock::GetTime());
+        ImGui::Text("Flipbooks: %i", m_animationSystem->GetAnimatedCount());
+        
+        Profiler::DrawOverlay();
+        
+        const RenderStats& stats = m_renderer->GetStats();
+        RenderThreadStats threadStats = m_window->GetRenderThreadStats();
+        
+        ImGui::SeparatorText("Renderer:");
+        
+        bool threadedRendering = m_window->IsThreadedRendering();
+        
+        if (ImGui::Checkbox("Threaded rendering", &threadedRendering))
+        {
+            m_window->SetThreadedRendering(threadedRendering);
+        }
+        
+        ImGui::Text("Frame time: %.2f ms", m_deltaTime * 1000.0F);
+        ImGui::Text(
+            "GL replay: %.2f ms (%i commands)",
+            threadStats.ReplayMilliseconds,
+            threadStats.CommandCount
+        );
+        ImGui::Text(
+            "Waited for GL thread: %.2f ms",
+            threadStats.WaitMilliseconds
+        );
+        if (m_sceneTarget)
+        {
+            glm::ivec2 sceneSize = m_sceneTarget->GetSize();
+
+            ImGui::Text(
+                "Scene target: %i x %i, upscaled to %i x %i",
+                sceneSize.x,
+                sceneSize.y,
+                m_sceneRect.z,
+                m_sceneRect.w
+            );
+        }
+        ImGui::Text("Textures loading: %i", TextureLoader::GetPendingCount());
+        ImGui::Text(
+            "Shader cache: %i hits, %i compiled, %.2f ms saved",
+            ShaderCache::GetHitCount(),
+            ShaderCache::GetMissCount(),
+            ShaderCache::GetSavedMilliseconds()
+        );
+        ImGui::Text("Draw calls: %i", stats.DrawCalls);
+        ImGui::Text("Sprite batches: %i", stats.BatchCount);
+        ImGui::Text("Sprites: %i", stats.SpriteCount);
+        ImGui::Text(
+            "Sprites visible: %i / %i",
+            stats.VisibleSprites,
+            stats.TotalSprites
+        );
+        ImGui::Text("Sprites re-sorted: %i", stats.SortedSprites);
+        ImGui::Text("Text meshes rebuilt: %i", stats.RebuiltTexts);
+        ImGui::Text(
+            "Transforms recomputed: %i",
+            m_transformSystem->GetRecomputedCount()
+        );
+        
+        ImGui::Text("Debug lines: %i", DebugShapes::GetStats().LineCount);
+        
+        const StreamBufferStats& streamStats = threadStats.Stream;
+        
+        ImGui::SeparatorText("Stream Buffer:");
+        ImGui::Text(
+            "Used: %.1f / %.1f KB",
+            (float)streamStats.BytesUsed / 1024.0F,
+            (float)streamStats.RegionSize / 1024.0F
+        );
+        ImGui::Text("Fence waits: %i", streamStats.FenceWaits);
+        ImGui::Text(
+            "Last wait: %.3f ms",
+            streamStats.LastWaitMilliseconds
+        );
+        ImGui::Text("Overflows: %i", streamStats.Overflows);
+        
+        const GLStateStats& stateStats = threadStats.State;
+        
+        ImGui::SeparatorText("GL State:");
+        ImGui::Text("State calls: %i", stateStats.Calls);
+        ImGui::Text("Redundant skipped: %i", stateStats.Redundant);
+        
+        if (GLTrace::IsInstalled())
+        {
+            const GLTraceStats& traceStats = threadStats.Trace;
+            
+            ImGui::SeparatorText("GL Calls:");
+            ImGui::Text(
+                "Total: %i (%.1f KB uploaded)",
+                traceStats.Calls,
+                (float)traceStats.UploadBytes / 1024.0F
+            );
+            
+            for (int scope = 0; scope < TraceScopeCount; scope++)
+            {
+                ImGui::Text(
+                    "%s: %i (%.1f KB)",
+                    GLTrace::GetScopeName((EGLTraceScope)scope),
+                    traceStats.ScopeCalls[scope],
+                    (float)traceStats.ScopeBytes[scope] / 1024.0F
+                );
+            }
+        }
+        
+        if (tilemapRenderMode == ETilemapRenderMode::Chunks)
+        {
+            const TilemapStats& tilemapStats = m_tileMap->GetStats();
+            
+            ImGui::SeparatorText("Tilemap:");
+            ImGui::Text("Chunks drawn: %i", tilemapStats.DrawnChunks);
+            ImGui::Text("Chunks resident: %i", tilemapStats.ResidentChunks);
+            ImGui::Text("Chunks pending: %i", tilemapStats.PendingChunks);
+            ImGui::Text("Chunks uploaded: %i", tilemapStats.UploadedChunks);
+        }
     }
     
     ImGui::End();
@@ -231,7 +631,14 @@ void Game::Destroy()
 {
     Log::Info("Shutting down...");
 
-    // Game shutdown
+    // Game shutdown, GL objects go while the context is current
+    m_sceneTarget.reset();
+    m_scene.reset();
+    m_font.reset();
+    TextureLoader::Destroy();
+    DebugShapes::Destroy();
+    Profiler::Destroy();
+    StreamBuffer::Destroy();
     ResourceManager::DestroyAll();
 }
 
@@ -257,5 +664,39 @@ void Game::OnKeyReleased(int key)
 
 void Game::OnWindowResize(int width, int height)
 {
-    m_camera->SetFrustumSize(width, height);
+    if (!m_sceneTarget)
+    {
+        m_camera->SetFrustumSize(width, height);
+        return;
+    }
+
+    glm::ivec2 sceneSize = m_sceneTarget->GetSize();
+    glm::ivec2 size = sceneSize;
+
+    // Largest whole multiple that fits, so every scene pixel
+    // covers the same number of window pixels
+    int scale = std::min(width / sceneSize.x, height / sceneSize.y);
+
+    if (scale >= 1)
+    {
+        size = sceneSize * scale;
+    }
+    else
+    {
+        // Window smaller than the scene, shrink to fit instead
+        float fit = std::min(
+            (float)width / (float)sceneSize.x,
+            (float)height / (float)sceneSize.y
+        );
+
+        size = glm::ivec2(glm::vec2(sceneSize) * fit);
+    }
+
+    // Centred, the rest is cleared as letterbox bars
+    m_sceneRect = glm::ivec4(
+        (width - size.x) / 2,
+        (height - size.y) / 2,
+        size.x,
+        size.y
+    );
 }
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Core/Scene/Entity.h"
+#include "Core/Systems/AnimationSystem.h"
 #include "Core/Systems/Renderer.h"
+#include "Core/Systems/TransformSystem.h"
 #include "Rendering/Sprite/Sprite.h"
 #include "Rendering/Camera.h"
+#include "Rendering/CommandList.h"
+#include "Rendering/FrameUniforms.h"
+#include "Rendering/RenderTarget.h"
 #include "Rendering/Font/BitmapFont.h"
 #include "IO/Audio/AudioEmitter.h"
 #include "IO/Tilemap/Tilemap.h"
@@ -14,9 +19,11 @@ class Game
     friend class Window;
 protected:
     void Init();
+    // Runs as many fixed ticks as the elapsed time allows
     void Update(float deltaTime);
     void RenderGUI();
-    void Render();
+    // Records the frame, replayed by the Window's RenderThread
+    void Render(CommandList& commands);
     void Destroy();
 
     // Engine events
@@ -25,6 +32,10 @@ protected:
 
     void OnWindowResize(int width, int height);
 
+private:
+    // One simulation step of 1 / m_tickRate seconds
+    void FixedUpdate(float tickTime);
+
 public:
     Game(Window* window);
     ~Game() = default;
@@ -35,6 +46,14 @@ private:
     std::shared_ptr<AudioEmitter> m_audioEmitter;
     std::shared_ptr<Tilemap> m_tileMap;
     std::shared_ptr<Renderer> m_renderer;
+    std::unique_ptr<TransformSystem> m_transformSystem;
+    std::unique_ptr<AnimationSystem> m_animationSystem;
+    std::unique_ptr<FrameUniforms> m_frameUniforms;
+
+    // Native resolution scene, and where it lands in the window
+    // as (x, y, width, height)
+    std::unique_ptr<RenderTarget> m_sceneTarget;
+    glm::ivec4 m_sceneRect = glm::ivec4(0);
 
     std::shared_ptr<Window> m_window;
     std::shared_ptr<Scene> m_scene;
@@ -43,8 +62,18 @@ private:
 
     static std::map<std::string, std::shared_ptr<Sprite>> m_sprites;
     std::vector<Entity> m_entities;
+    std::vector<Entity> m_ghosts;
+
+    float m_deltaTime = 0.0F;
+
+    // Fixed timestep state
+    float m_accumulator = 0.0F;
+    float m_tickAlpha = 0.0F;
+    int m_ticksThisFrame = 0;
+    int m_clampedFrames = 0;
 
 private: // Settings
     int m_selectedEditorItem = 0;
+    float m_tickRate;
     bool m_showCollision = true;
 };
@@ -0,0 +1,120 @@
+#include "CookedTexture.h"
+
+#include <glad/glad.h>
+#include <filesystem>
+#include <fstream>
+
+// Size and write time of a source image, zero if it is missing
+static bool GetSourceStamp(
+    const std::string& sourcePath,
+    uint64_t& size,
+    int64_t& time)
+{
+    std::error_code error;
+
+    size = (uint64_t)std::filesystem::file_size(sourcePath, error);
+
+    if (error)
+    {
+        return false;
+    }
+
+    time = (int64_t)std::filesystem::last_write_time(sourcePath, error)
+        .time_since_epoch()
+        .count();
+
+    return !error;
+}
+
+std::unique_ptr<CookedTexture> CookedTexture::Open(const std::string& sourcePath)
+{
+    auto cooked = std::make_unique<CookedTexture>();
+
+    if (!cooked->m_file.Open(GetCookedPath(sourcePath)) ||
+        cooked->m_file.GetSize() < sizeof(CookedTextureHeader))
+    {
+        return nullptr;
+    }
+
+    const CookedTextureHeader& header = cooked->GetHeader();
+
+    if (header.Magic != COOKED_TEXTURE_MAGIC ||
+        header.Version != COOKED_TEXTURE_VERSION ||
+        header.Format != GL_RGBA ||
+        header.Type != GL_UNSIGNED_BYTE ||
+        header.DataSize != (uint64_t)header.Width * header.Height * 4 ||
+        cooked->m_file.GetSize() < sizeof(CookedTextureHeader) + header.DataSize)
+    {
+        return nullptr;
+    }
+
+    // Shipped without its source is fine, an edited source is not
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+
+    if (GetSourceStamp(sourcePath, sourceSize, sourceTime) &&
+        (sourceSize != header.SourceSize || sourceTime != header.SourceTime))
+    {
+        return nullptr;
+    }
+
+    return cooked;
+}
+
+bool CookedTexture::Write(
+    const std::string& sourcePath,
+    const unsigned char* pixels,
+    int width,
+    int height,
+    int divisionsX,
+    int divisionsY)
+{
+    CookedTextureHeader header = {};
+    header.Magic = COOKED_TEXTURE_MAGIC;
+    header.Version = COOKED_TEXTURE_VERSION;
+    header.Width = (uint32_t)width;
+    header.Height = (uint32_t)height;
+    header.DivisionsX = (uint32_t)divisionsX;
+    header.DivisionsY = (uint32_t)divisionsY;
+    header.InternalFormat = GL_RGBA8;
+    header.Format = GL_RGBA;
+    header.Type = GL_UNSIGNED_BYTE;
+    header.DataSize = (uint64_t)width * height * 4;
+
+    if (!GetSourceStamp(sourcePath, header.SourceSize, header.SourceTime))
+    {
+        return false;
+    }
+
+    std::ofstream out(
+        GetCookedPath(sourcePath),
+        std::ios::out | std::ios::binary | std::ios::trunc
+    );
+
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)pixels, (std::streamsize)header.DataSize);
+
+    return out.good();
+}
+
+std::string CookedTexture::GetCookedPath(const std::string& sourcePath)
+{
+    return std::filesystem::path(sourcePath)
+        .replace_extension(COOKED_TEXTURE_EXTENSION)
+        .string();
+}
+
+const CookedTextureHeader& CookedTexture::GetHeader() const
+{
+    return *(const CookedTextureHeader*)m_file.GetData();
+}
+
+const unsigned char* CookedTexture::GetTexels() const
+{
+    return m_file.GetData() + sizeof(CookedTextureHeader);
+}
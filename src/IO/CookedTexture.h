@@ -0,0 +1,76 @@
+#pragma once
+
+#include "IO/MappedFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// "CTEX" read as a little endian integer
+#define COOKED_TEXTURE_MAGIC        0x58455443u
+#define COOKED_TEXTURE_VERSION      1
+#define COOKED_TEXTURE_EXTENSION    ".ctex"
+
+// Start of a .ctex file, followed directly by DataSize bytes of
+// texels laid out exactly as glTexImage2D takes them
+struct CookedTextureHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+
+    uint32_t Width;
+    uint32_t Height;
+
+    // Tile or animation frame grid of the image
+    uint32_t DivisionsX;
+    uint32_t DivisionsY;
+
+    // glTexImage2D arguments for the texels
+    uint32_t InternalFormat;
+    uint32_t Format;
+    uint32_t Type;
+    uint32_t Padding;
+
+    // Size and write time of the image it was cooked from, a
+    // mismatch means the cooked file is stale
+    uint64_t SourceSize;
+    int64_t SourceTime;
+
+    uint64_t DataSize;
+};
+
+static_assert(
+    sizeof(CookedTextureHeader) == 64,
+    "CookedTextureHeader is written to disk as is"
+);
+
+// A texture cooked by the asset_cooker tool, mapped into memory so
+// it can be uploaded without decoding or copying
+class CookedTexture
+{
+public:
+    // Maps the cooked twin of `sourcePath`, or returns null if it
+    // is missing, stale or not a format this build understands
+    static std::unique_ptr<CookedTexture> Open(const std::string& sourcePath);
+
+    // Cooks RGBA8 `pixels` decoded from `sourcePath` next to it
+    static bool Write(
+        const std::string& sourcePath,
+        const unsigned char* pixels,
+        int width,
+        int height,
+        int divisionsX = 1,
+        int divisionsY = 1
+    );
+
+    // `sourcePath` with its extension swapped for .ctex
+    static std::string GetCookedPath(const std::string& sourcePath);
+
+    [[nodiscard]]
+    const CookedTextureHeader& GetHeader() const;
+    [[nodiscard]]
+    const unsigned char* GetTexels() const;
+
+private:
+    MappedFile m_file;
+};
@@ -1,8 +1,24 @@
 #include "ResourceManager.h"
 #include "Core/Log.h"
+#include "Rendering/GLState.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
 
 std::map<std::string, std::shared_ptr<Texture>> ResourceManager::Textures;
 std::map<std::string, std::shared_ptr<Shader>> ResourceManager::Shaders;
+std::map<unsigned int, TextureRegion> ResourceManager::AtlasRegions;
+std::vector<std::shared_ptr<Texture>> ResourceManager::AtlasPages;
+
+std::unordered_map<uint64_t, std::shared_ptr<Texture>> ResourceManager::m_texturesByHash;
+std::unordered_map<std::string, uint64_t> ResourceManager::m_pathHashes;
+std::unordered_map<std::string, std::shared_ptr<Texture>> ResourceManager::m_pendingTextures;
+std::unordered_map<unsigned int, uint64_t> ResourceManager::m_textureHashes;
+std::unordered_map<unsigned int, int> ResourceManager::m_textureReferences;
+std::vector<unsigned int> ResourceManager::m_releasedTextures;
+std::vector<std::shared_ptr<Texture>> ResourceManager::m_mergedTextures;
+std::unordered_map<uint64_t, std::shared_ptr<Shader>> ResourceManager::m_shadersByKey;
 
 ResourceManager::ResourceManager()
 {
@@ -16,13 +32,25 @@ std::shared_ptr<Shader> ResourceManager::LoadShader(
 {
     if (Shaders.contains(name))
     {
+        // Queued programs are finished on first use
+        Shaders[name]->Finish();
         return Shaders[name];
     }
 
+    ShaderSource source = Shader::ReadSource(vertPath, fragPath);
+
+    if (std::shared_ptr<Shader> shared = ShareShader(source, name))
+    {
+        shared->Finish();
+        return shared;
+    }
+
     auto shader = std::make_shared<Shader>();
-    shader->Load(vertPath, fragPath);
+    shader->Begin(source);
+    shader->Finish();
 
     Shaders[name] = shader;
+    m_shadersByKey[source.Key] = shader;
 
     Log::Info(
         "[ResourceManager] Shader created: [%s]",
@@ -49,19 +77,199 @@ bool ResourceManager::HasShader(const std::string &name)
     return Shaders.contains(name);
 }
 
+std::shared_ptr<Shader> ResourceManager::QueueShader(
+    const char* vertPath,
+    const char* fragPath,
+    const std::string& name)
+{
+    if (Shaders.contains(name))
+    {
+        return Shaders[name];
+    }
+
+    ShaderSource source = Shader::ReadSource(vertPath, fragPath);
+
+    if (std::shared_ptr<Shader> shared = ShareShader(source, name))
+    {
+        return shared;
+    }
+
+    auto shader = std::make_shared<Shader>();
+    shader->Begin(source);
+
+    Shaders[name] = shader;
+    m_shadersByKey[source.Key] = shader;
+
+    Log::Info(
+        "[ResourceManager] Shader queued: [%s]",
+        name.c_str()
+    );
+
+    return shader;
+}
+
+std::shared_ptr<Shader> ResourceManager::ShareShader(
+    const ShaderSource& source,
+    const std::string& name)
+{
+    auto existing = m_shadersByKey.find(source.Key);
+
+    if (existing == m_shadersByKey.end())
+    {
+        return nullptr;
+    }
+
+    // Same sources build the same program, add the name to it
+    Shaders[name] = existing->second;
+
+    Log::Info(
+        "[ResourceManager] Shader [%s] shares an identical program",
+        name.c_str()
+    );
+
+    return existing->second;
+}
+
+void ResourceManager::FinishShaders()
+{
+    while (true)
+    {
+        std::shared_ptr<Shader> pending;
+        bool progressed = false;
+
+        for (const auto& shader : Shaders)
+        {
+            if (shader.second->IsFinished())
+            {
+                continue;
+            }
+
+            if (shader.second->IsReady())
+            {
+                shader.second->Finish();
+                progressed = true;
+            }
+            else if (!pending)
+            {
+                pending = shader.second;
+            }
+        }
+
+        if (!pending)
+        {
+            return;
+        }
+
+        // Nothing done yet, block on one rather than spin
+        if (!progressed)
+        {
+            pending->Finish();
+        }
+    }
+}
+
 std::shared_ptr<Texture> ResourceManager::LoadTexture(const char* path, const std::string& name)
 {
+    // Loading in the background, finished here instead
+    auto pending = m_pendingTextures.find(path);
+
+    if (pending != m_pendingTextures.end())
+    {
+        std::shared_ptr<Texture> texture = pending->second;
+
+        TextureLoader::Wait({ texture });
+        SetTextureName(name, texture);
+
+        return texture;
+    }
+
+    uint64_t hash = GetImageHash(path);
+
+    if (auto texture = FindTexture(hash, name))
+    {
+        return texture;
+    }
+
     auto texture = std::make_shared<Texture>();
     texture->LoadTexture(path);
 
-    Textures[name] = texture;
+    AddTexture(hash, name, texture);
 
     Log::Info(
         "[ResourceManager] Texture created: [%s]",
         name.c_str()
     );
 
-    return Textures[name];
+    return texture;
+}
+
+std::shared_ptr<Texture> ResourceManager::LoadTextureAsync(
+    const char* path,
+    const std::string& name,
+    TextureLoadCallback onLoaded)
+{
+    std::shared_ptr<Texture> texture;
+
+    // Hashing happens on the loader, only paths seen before are known
+    auto cached = m_pathHashes.find(path);
+    auto pending = m_pendingTextures.find(path);
+
+    if (cached != m_pathHashes.end())
+    {
+        texture = FindTexture(cached->second, name);
+    }
+    else if (pending != m_pendingTextures.end())
+    {
+        texture = pending->second;
+        SetTextureName(name, texture);
+
+        Log::Info(
+            "[ResourceManager] Texture [%s] shares an image still loading",
+            name.c_str()
+        );
+    }
+
+    if (texture)
+    {
+        // Still loading, or ready already
+        if (onLoaded && !TextureLoader::AddCallback(texture, onLoaded))
+        {
+            onLoaded(texture);
+        }
+
+        return texture;
+    }
+
+    // Transparent until the real image is uploaded
+    texture = TextureLoader::CreatePlaceholder();
+
+    AddTexture(0, name, texture);
+    m_pendingTextures[path] = texture;
+
+    TextureLoader::Load(
+        texture,
+        path,
+        std::move(onLoaded),
+        [path = std::string(path)](
+            const std::shared_ptr<Texture>& loaded,
+            uint64_t hash)
+        {
+            OnTextureHashed(path, loaded, hash);
+        }
+    );
+
+    Log::Info(
+        "[ResourceManager] Texture queued: [%s]",
+        name.c_str()
+    );
+
+    return texture;
+}
+
+void ResourceManager::WaitForTextures(
+    const std::vector<std::shared_ptr<Texture>>& textures)
+{
+    TextureLoader::Wait(textures);
 }
 
 std::shared_ptr<Texture> ResourceManager::GetTexture(const std::string& name)
@@ -76,16 +284,501 @@ std::shared_ptr<Texture> ResourceManager::GetTexture(const std::string& name)
     return Textures[name];
 }
 
+void ResourceManager::ReleaseTexture(const std::string& name)
+{
+    auto it = Textures.find(name);
+
+    if (it == Textures.end())
+    {
+        return;
+    }
+
+    std::shared_ptr<Texture> texture = it->second;
+
+    if (IsAtlasPage(texture))
+    {
+        Log::Warning(
+            "[ResourceManager] Texture [%s] is an atlas page, not releasing it",
+            name.c_str()
+        );
+        return;
+    }
+
+    Textures.erase(it);
+
+    unsigned int id = texture->ID;
+
+    if (--m_textureReferences[id] > 0)
+    {
+        return;
+    }
+
+    m_textureReferences.erase(id);
+
+    // Nothing is uploaded into it or called back after this
+    TextureLoader::Cancel(texture);
+    std::erase_if(m_pendingTextures, [&](const auto& pending)
+    {
+        return pending.second == texture;
+    });
+
+    // Forget the content, a later load creates it again
+    auto hash = m_textureHashes.find(id);
+
+    if (hash != m_textureHashes.end())
+    {
+        m_texturesByHash.erase(hash->second);
+        std::erase_if(m_pathHashes, [&](const auto& pathHash)
+        {
+            return pathHash.second == hash->second;
+        });
+        m_textureHashes.erase(hash);
+    }
+
+    // GL reuses the name, it must not find the old region
+    AtlasRegions.erase(id);
+
+    // Recorded GL work may still use it, deleted in command order
+    m_releasedTextures.emplace_back(id);
+
+    Log::Info(
+        "[ResourceManager] Texture released: [%s]",
+        name.c_str()
+    );
+}
+
+void ResourceManager::Update(CommandList& commands)
+{
+    // Merged copies nobody holds any more
+    std::erase_if(m_mergedTextures, [](const std::shared_ptr<Texture>& texture)
+    {
+        if (texture.use_count() > 1)
+        {
+            return false;
+        }
+
+        AtlasRegions.erase(texture->ID);
+        m_releasedTextures.emplace_back(texture->ID);
+
+        return true;
+    });
+
+    if (m_releasedTextures.empty())
+    {
+        return;
+    }
+
+    commands.Execute([released = std::move(m_releasedTextures)]()
+    {
+        for (unsigned int id : released)
+        {
+            GLState::DeleteTexture(id);
+        }
+    });
+
+    m_releasedTextures.clear();
+}
+
+int ResourceManager::GetTextureReferences(const std::shared_ptr<Texture>& texture)
+{
+    auto it = m_textureReferences.find(texture->ID);
+
+    return it != m_textureReferences.end() ? it->second : 0;
+}
+
+void ResourceManager::PackAtlas(
+    const std::vector<std::shared_ptr<Texture>>& textures,
+    int pageSize,
+    int padding)
+{
+    struct PackEntry
+    {
+        std::shared_ptr<Texture> Source;
+        std::vector<unsigned char> Pixels;
+        glm::ivec2 Position = { 0, 0 };
+        int Page = 0;
+    };
+
+    std::vector<PackEntry> entries;
+    entries.reserve(textures.size());
+
+    // Read back source pixels
+    for (const auto& texture : textures)
+    {
+        // Already packed, or listed twice under different names
+        bool queued = std::any_of(
+            entries.begin(),
+            entries.end(),
+            [&](const PackEntry& entry)
+            {
+                return entry.Source == texture;
+            }
+        );
+
+        if (AtlasRegions.contains(texture->ID) || queued)
+        {
+            continue;
+        }
+
+        if (texture->Width + padding * 2 > pageSize ||
+            texture->Height + padding * 2 > pageSize)
+        {
+            Log::Warning(
+                "[ResourceManager] Texture %i (%ix%i) does not fit in a "
+                "%ix%i atlas page, skipping",
+                texture->ID,
+                texture->Width,
+                texture->Height,
+                pageSize,
+                pageSize
+            );
+            continue;
+        }
+
+        PackEntry entry = {};
+        entry.Source = texture;
+        entry.Pixels.resize((size_t)texture->Width * texture->Height * 4);
+
+        texture->Bind();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(
+            GL_TEXTURE_2D,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            entry.Pixels.data()
+        );
+
+        entries.emplace_back(std::move(entry));
+    }
+
+    GLState::BindTexture(0, 0);
+
+    if (entries.empty())
+    {
+        return;
+    }
+
+    // Shelf packing, tallest first
+    std::sort(entries.begin(), entries.end(), [](
+        const PackEntry& lhs,
+        const PackEntry& rhs)
+    {
+        return lhs.Source->Height > rhs.Source->Height;
+    });
+
+    std::vector<int> pageHeights = { 0 };
+    glm::ivec2 cursor = { 0, 0 };
+    int shelfHeight = 0;
+
+    for (PackEntry& entry : entries)
+    {
+        glm::ivec2 padded = glm::ivec2(
+            entry.Source->Width,
+            entry.Source->Height
+        ) + padding * 2;
+
+        // Next shelf
+        if (cursor.x + padded.x > pageSize)
+        {
+            cursor = glm::ivec2(0, cursor.y + shelfHeight);
+            shelfHeight = 0;
+        }
+
+        // Next page
+        if (cursor.y + padded.y > pageSize)
+        {
+            cursor = glm::ivec2(0);
+            shelfHeight = 0;
+            pageHeights.emplace_back(0);
+        }
+
+        entry.Page = (int)pageHeights.size() - 1;
+        entry.Position = cursor + padding;
+
+        pageHeights.back() = std::max(pageHeights.back(), cursor.y + padded.y);
+        shelfHeight = std::max(shelfHeight, padded.y);
+        cursor.x += padded.x;
+    }
+
+    // Build and upload each page
+    for (int page = 0; page < (int)pageHeights.size(); page++)
+    {
+        int pageHeight = pageHeights[page];
+        std::vector<unsigned char> pixels((size_t)pageSize * pageHeight * 4, 0);
+
+        for (const PackEntry& entry : entries)
+        {
+            if (entry.Page != page)
+            {
+                continue;
+            }
+
+            int width = entry.Source->Width;
+            int height = entry.Source->Height;
+
+            // Copy rows, extruding the edge pixels into the padding
+            for (int y = -padding; y < height + padding; y++)
+            {
+                int sourceY = std::clamp(y, 0, height - 1);
+
+                for (int x = -padding; x < width + padding; x++)
+                {
+                    int sourceX = std::clamp(x, 0, width - 1);
+
+                    const unsigned char* source = entry.Pixels.data() +
+                        ((size_t)sourceY * width + sourceX) * 4;
+                    unsigned char* destination = pixels.data() +
+                        ((size_t)(entry.Position.y + y) * pageSize +
+                            entry.Position.x + x) * 4;
+
+                    std::memcpy(destination, source, 4);
+                }
+            }
+        }
+
+        auto pageTexture = std::make_shared<Texture>();
+        pageTexture->Generate(pageSize, pageHeight, pixels.data());
+
+        AddTexture(
+            0,
+            std::format("AtlasPage{}", AtlasPages.size()),
+            pageTexture
+        );
+
+        for (const PackEntry& entry : entries)
+        {
+            if (entry.Page != page)
+            {
+                continue;
+            }
+
+            TextureRegion region = {};
+            region.Page = pageTexture;
+            region.Offset = entry.Position;
+            region.Size = glm::ivec2(
+                entry.Source->Width,
+                entry.Source->Height
+            );
+
+            AtlasRegions[entry.Source->ID] = region;
+        }
+
+        Log::Info(
+            "[ResourceManager] Atlas page %zu created: [%ix%i]",
+            AtlasPages.size(),
+            pageSize,
+            pageHeight
+        );
+
+        AtlasPages.emplace_back(pageTexture);
+    }
+}
+
+TextureRegion ResourceManager::GetTextureRegion(
+    const std::shared_ptr<Texture>& texture)
+{
+    auto it = AtlasRegions.find(texture->ID);
+
+    if (it != AtlasRegions.end())
+    {
+        return it->second;
+    }
+
+    TextureRegion region = {};
+    region.Page = texture;
+    region.Size = glm::ivec2(texture->Width, texture->Height);
+
+    return region;
+}
+
 void ResourceManager::DestroyAll()
 {
-    for (const auto& shader : Shaders)
+    // Once per program, however many names it has
+    for (const auto& shader : m_shadersByKey)
+    {
+        GLState::DeleteProgram(shader.second->ID);
+    }
+
+    // Once per texture, however many names it has
+    for (const auto& texture : m_textureReferences)
     {
-        glDeleteProgram(shader.second->ID);
+        GLState::DeleteTexture(texture.first);
     }
-    for (const auto& texture : Textures)
+
+    for (unsigned int id : m_releasedTextures)
+    {
+        GLState::DeleteTexture(id);
+    }
+
+    for (const auto& texture : m_mergedTextures)
     {
-        glDeleteTextures(1, &texture.second->ID);
+        GLState::DeleteTexture(texture->ID);
     }
 
+    Textures.clear();
+    AtlasRegions.clear();
+    AtlasPages.clear();
+    m_texturesByHash.clear();
+    m_pathHashes.clear();
+    m_pendingTextures.clear();
+    m_textureHashes.clear();
+    m_textureReferences.clear();
+    m_releasedTextures.clear();
+    m_mergedTextures.clear();
+    m_shadersByKey.clear();
+
     Log::Info("[ResourceManager] Shutdown - deallocated all bound resources");
 }
+
+uint64_t ResourceManager::GetImageHash(const std::string& path)
+{
+    auto cached = m_pathHashes.find(path);
+
+    if (cached != m_pathHashes.end())
+    {
+        return cached->second;
+    }
+
+    uint64_t hash = TextureLoader::HashImage(path);
+
+    m_pathHashes[path] = hash;
+
+    return hash;
+}
+
+void ResourceManager::OnTextureHashed(
+    const std::string& path,
+    const std::shared_ptr<Texture>& texture,
+    uint64_t hash)
+{
+    m_pendingTextures.erase(path);
+    m_pathHashes[path] = hash;
+
+    // Unreadable files are never shared
+    if (hash == 0)
+    {
+        return;
+    }
+
+    auto it = m_texturesByHash.find(hash);
+
+    if (it == m_texturesByHash.end())
+    {
+        m_texturesByHash[hash] = texture;
+        m_textureHashes[texture->ID] = hash;
+        return;
+    }
+
+    const std::shared_ptr<Texture>& original = it->second;
+
+    if (original == texture)
+    {
+        return;
+    }
+
+    // Loaded under another path meanwhile. The names move over, the
+    // copy stays valid for whoever holds it and is freed after them.
+    unsigned int id = texture->ID;
+
+    for (auto& named : Textures)
+    {
+        if (named.second == texture)
+        {
+            named.second = original;
+        }
+    }
+
+    m_textureReferences[original->ID] += m_textureReferences[id];
+    m_textureReferences.erase(id);
+    m_mergedTextures.emplace_back(texture);
+
+    Log::Info(
+        "[ResourceManager] %s holds an already loaded image, its names "
+        "now share it",
+        path.c_str()
+    );
+}
+
+bool ResourceManager::IsAtlasPage(const std::shared_ptr<Texture>& texture)
+{
+    return std::find(
+        AtlasPages.begin(),
+        AtlasPages.end(),
+        texture) != AtlasPages.end();
+}
+
+std::shared_ptr<Texture> ResourceManager::FindTexture(
+    uint64_t hash,
+    const std::string& name)
+{
+    // Unreadable files are never shared
+    if (hash == 0)
+    {
+        return nullptr;
+    }
+
+    auto it = m_texturesByHash.find(hash);
+
+    if (it == m_texturesByHash.end())
+    {
+        return nullptr;
+    }
+
+    SetTextureName(name, it->second);
+
+    Log::Info(
+        "[ResourceManager] Texture [%s] shares an already loaded image",
+        name.c_str()
+    );
+
+    return it->second;
+}
+
+void ResourceManager::AddTexture(
+    uint64_t hash,
+    const std::string& name,
+    const std::shared_ptr<Texture>& texture)
+{
+    if (hash != 0)
+    {
+        m_texturesByHash[hash] = texture;
+        m_textureHashes[texture->ID] = hash;
+    }
+
+    SetTextureName(name, texture);
+}
+
+void ResourceManager::SetTextureName(
+    const std::string& name,
+    const std::shared_ptr<Texture>& texture)
+{
+    auto it = Textures.find(name);
+
+    if (it != Textures.end())
+    {
+        if (it->second == texture)
+        {
+            return;
+        }
+
+        Log::Warning(
+            "[ResourceManager] Texture name [%s] was taken by another "
+            "image, moving it",
+            name.c_str()
+        );
+
+        // Pages outlive their names, their regions still use them
+        if (IsAtlasPage(it->second))
+        {
+            m_textureReferences[it->second->ID] -= 1;
+        }
+        else
+        {
+            ReleaseTexture(name);
+        }
+    }
+
+    Textures[name] = texture;
+    m_textureReferences[texture->ID] += 1;
+}
@@ -1,11 +1,19 @@
 #pragma once
 
+#include "Rendering/CommandList.h"
 #include "Rendering/Shader.h"
 #include "Rendering/Texture.h"
+#include "IO/TextureLoader.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+
+#define ATLAS_PAGE_SIZE     1024
+#define ATLAS_PADDING       2
 
 class ResourceManager
 {
@@ -13,6 +21,10 @@ public:
     static std::map<std::string, std::shared_ptr<Shader>> Shaders;
     static std::map<std::string, std::shared_ptr<Texture>> Textures;
 
+    // Atlas regions keyed by the ID of the texture they were packed from
+    static std::map<unsigned int, TextureRegion> AtlasRegions;
+    static std::vector<std::shared_ptr<Texture>> AtlasPages;
+
     static std::shared_ptr<Shader> LoadShader(
         const char* vertPath,
         const char* fragPath,
@@ -21,14 +33,131 @@ public:
     static std::shared_ptr<Shader> GetShader(const std::string& name);
     static bool HasShader(const std::string& name);
 
+    // Starts building a program without waiting on it. Loading the
+    // same name later finishes it, as does FinishShaders(). Names
+    // whose sources match an existing program share it.
+    static std::shared_ptr<Shader> QueueShader(
+        const char* vertPath,
+        const char* fragPath,
+        const std::string& name
+    );
+
+    // Finishes every queued program, in the order the driver
+    // completes them where it compiles in parallel
+    static void FinishShaders();
+
+    // Textures are identified by a hash of their file. Loading an
+    // image that is already loaded (by any path) adds `name` to the
+    // existing texture instead of creating another one. Uploads on
+    // the calling thread, so it needs the context.
     static std::shared_ptr<Texture> LoadTexture(
         const char* path,
         const std::string& name
     );
+
+    // Returns a placeholder at once, the image is decoded and
+    // uploaded in the background by the TextureLoader. Only the
+    // path is known until the loader has hashed the file. If it is a
+    // copy of an image loaded under another path, its names move to
+    // that texture then and the copy is freed once nobody holds it.
+    static std::shared_ptr<Texture> LoadTextureAsync(
+        const char* path,
+        const std::string& name,
+        TextureLoadCallback onLoaded = nullptr
+    );
+
+    // Finishes the given async loads now, needs the context
+    static void WaitForTextures(
+        const std::vector<std::shared_ptr<Texture>>& textures
+    );
+
     static std::shared_ptr<Texture> GetTexture(const std::string& name);
 
+    // Removes a name, the GL texture is freed along with its last
+    // name (by the next Update) and a load still running is
+    // dropped. Holders of the texture must not use it after that.
+    // Atlas pages are kept, their regions still point at them.
+    static void ReleaseTexture(const std::string& name);
+
+    // Records the deletes of textures released since the last call,
+    // and of merged copies no longer held
+    static void Update(CommandList& commands);
+
+    // Names currently referring to the texture
+    [[nodiscard]]
+    static int GetTextureReferences(const std::shared_ptr<Texture>& texture);
+
+    // Packs already loaded textures into shared atlas pages. Each
+    // texture is surrounded by `padding` pixels of its own extruded
+    // edge so nearest-filtered neighbours never bleed into it.
+    static void PackAtlas(
+        const std::vector<std::shared_ptr<Texture>>& textures,
+        int pageSize = ATLAS_PAGE_SIZE,
+        int padding = ATLAS_PADDING
+    );
+
+    // Region of the atlas a texture was packed into, or the
+    // whole texture if it was never packed
+    static TextureRegion GetTextureRegion(
+        const std::shared_ptr<Texture>& texture
+    );
+
     static void DestroyAll();
 
 private:
     ResourceManager();
+
+    // TextureLoader::HashImage, remembered by path
+    static uint64_t GetImageHash(const std::string& path);
+
+    // Called back once the loader knows what `path` holds
+    static void OnTextureHashed(
+        const std::string& path,
+        const std::shared_ptr<Texture>& texture,
+        uint64_t hash
+    );
+
+    [[nodiscard]]
+    static bool IsAtlasPage(const std::shared_ptr<Texture>& texture);
+
+    // The loaded texture with this content, after naming it `name`
+    static std::shared_ptr<Texture> FindTexture(
+        uint64_t hash,
+        const std::string& name
+    );
+    static void AddTexture(
+        uint64_t hash,
+        const std::string& name,
+        const std::shared_ptr<Texture>& texture
+    );
+    static void SetTextureName(
+        const std::string& name,
+        const std::shared_ptr<Texture>& texture
+    );
+
+    // Adds `name` to the program built from the same sources, if any
+    static std::shared_ptr<Shader> ShareShader(
+        const ShaderSource& source,
+        const std::string& name
+    );
+
+    static std::unordered_map<uint64_t, std::shared_ptr<Texture>> m_texturesByHash;
+    static std::unordered_map<std::string, uint64_t> m_pathHashes;
+
+    // Async loads not hashed yet, by path
+    static std::unordered_map<std::string, std::shared_ptr<Texture>> m_pendingTextures;
+
+    // By texture ID
+    static std::unordered_map<unsigned int, uint64_t> m_textureHashes;
+    static std::unordered_map<unsigned int, int> m_textureReferences;
+
+    // Released texture IDs waiting for Update
+    static std::vector<unsigned int> m_releasedTextures;
+
+    // Async loads that turned out to copy a loaded image, their names
+    // moved to it. Released by Update once nothing else holds them.
+    static std::vector<std::shared_ptr<Texture>> m_mergedTextures;
+
+    // By source key, each program once
+    static std::unordered_map<uint64_t, std::shared_ptr<Shader>> m_shadersByKey;
 };
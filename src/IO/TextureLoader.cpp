@@ -0,0 +1,690 @@
+#include "TextureLoader.h"
+#include "Core/Log.h"
+#include "Rendering/GLState.h"
+#include "Rendering/Debug/GLTrace.h"
+
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+
+std::vector<std::thread> TextureLoader::m_workers;
+std::mutex TextureLoader::m_mutex;
+std::condition_variable TextureLoader::m_queueCondition;
+std::condition_variable TextureLoader::m_decodedCondition;
+bool TextureLoader::m_stop = false;
+
+std::deque<std::shared_ptr<TextureLoader::Request>> TextureLoader::m_queue;
+std::vector<std::shared_ptr<TextureLoader::Request>> TextureLoader::m_requests;
+std::vector<std::shared_ptr<TextureLoader::Request>> TextureLoader::m_uploading;
+
+std::vector<unsigned int> TextureLoader::m_freePlaceholders;
+std::vector<unsigned int> TextureLoader::m_generatedPlaceholders;
+bool TextureLoader::m_generatingPlaceholders = false;
+
+unsigned int TextureLoader::m_PBO = 0;
+
+void TextureLoader::Init(int workerCount)
+{
+    // Leave a core to the main and GL threads
+    int hardwareThreads = (int)std::thread::hardware_concurrency() - 1;
+    int count = std::clamp(hardwareThreads, 1, std::max(workerCount, 1));
+
+    m_stop = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        m_workers.emplace_back(WorkerLoop);
+    }
+
+    // Called with the context current, later ones come from Update
+    m_freePlaceholders = GeneratePlaceholders(TEXTURE_PLACEHOLDER_RESERVE);
+    m_generatingPlaceholders = false;
+
+    Log::Info("[TextureLoader] Started %i decoding threads", count);
+}
+
+void TextureLoader::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_queueCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    m_workers.clear();
+    m_queue.clear();
+
+    for (const auto& request : m_requests)
+    {
+        ReleasePixels(*request);
+    }
+
+    m_requests.clear();
+
+    // Anything left here was never replayed
+    for (const auto& request : m_uploading)
+    {
+        ReleasePixels(*request);
+    }
+
+    m_uploading.clear();
+
+    for (unsigned int placeholder : m_freePlaceholders)
+    {
+        GLState::DeleteTexture(placeholder);
+    }
+
+    for (unsigned int placeholder : m_generatedPlaceholders)
+    {
+        GLState::DeleteTexture(placeholder);
+    }
+
+    m_freePlaceholders.clear();
+    m_generatedPlaceholders.clear();
+
+    if (m_PBO != 0)
+    {
+        GLState::DeleteBuffer(m_PBO);
+        m_PBO = 0;
+    }
+}
+
+std::shared_ptr<Texture> TextureLoader::CreatePlaceholder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_freePlaceholders.insert(
+            m_freePlaceholders.end(),
+            m_generatedPlaceholders.begin(),
+            m_generatedPlaceholders.end()
+        );
+
+        if (!m_generatedPlaceholders.empty())
+        {
+            m_generatedPlaceholders.clear();
+            m_generatingPlaceholders = false;
+        }
+    }
+
+    if (m_freePlaceholders.empty())
+    {
+        // Only safe where the context is current (Init, in-line rendering)
+        if (!glfwGetCurrentContext())
+        {
+            Log::Critical(
+                "[TextureLoader] Out of placeholders, more than %i "
+                "textures were queued in a frame",
+                TEXTURE_PLACEHOLDER_RESERVE
+            );
+        }
+
+        m_freePlaceholders = GeneratePlaceholders(1);
+    }
+
+    auto texture = std::make_shared<Texture>(m_freePlaceholders.back());
+    m_freePlaceholders.pop_back();
+
+    // As GeneratePlaceholders left it
+    texture->Width = 1;
+    texture->Height = 1;
+    texture->InternalFormat = GL_RGBA;
+    texture->ImageFormat = GL_RGBA;
+
+    return texture;
+}
+
+void TextureLoader::Load(
+    const std::shared_ptr<Texture>& texture,
+    const std::string& path,
+    TextureLoadCallback onLoaded,
+    TextureHashCallback onHashed)
+{
+    auto request = std::make_shared<Request>();
+    request->Target = texture;
+    request->Path = path;
+    request->OnLoaded = std::move(onLoaded);
+    request->OnHashed = std::move(onHashed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(request);
+        m_requests.emplace_back(request);
+    }
+
+    m_queueCondition.notify_one();
+}
+
+bool TextureLoader::AddCallback(
+    const std::shared_ptr<Texture>& texture,
+    TextureLoadCallback onLoaded)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto loading = [&texture](const std::shared_ptr<Request>& request)
+    {
+        return request->Target == texture;
+    };
+
+    auto it = std::find_if(m_requests.begin(), m_requests.end(), loading);
+
+    // Or uploaded but not finished yet
+    if (it == m_requests.end())
+    {
+        it = std::find_if(m_uploading.begin(), m_uploading.end(), loading);
+
+        if (it == m_uploading.end())
+        {
+            return false;
+        }
+    }
+
+    const auto& request = *it;
+
+    if (!request->OnLoaded)
+    {
+        request->OnLoaded = std::move(onLoaded);
+    }
+    else
+    {
+        request->OnLoaded = [
+            first = std::move(request->OnLoaded),
+            second = std::move(onLoaded)
+        ](const std::shared_ptr<Texture>& loaded)
+        {
+            first(loaded);
+            second(loaded);
+        };
+    }
+
+    return true;
+}
+
+void TextureLoader::Cancel(const std::shared_ptr<Texture>& texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto loading = [&texture](const std::shared_ptr<Request>& request)
+    {
+        return request->Target == texture;
+    };
+
+    std::erase_if(m_queue, loading);
+
+    for (auto it = m_requests.begin(); it != m_requests.end();)
+    {
+        const auto& request = *it;
+
+        if (!loading(request))
+        {
+            ++it;
+            continue;
+        }
+
+        if (request->Decoded)
+        {
+            ReleasePixels(*request);
+        }
+        else
+        {
+            request->Cancelled = true;
+        }
+
+        it = m_requests.erase(it);
+    }
+
+    std::erase_if(m_uploading, loading);
+}
+
+void TextureLoader::Update(CommandList& commands, size_t budget)
+{
+    // Uploads replayed on the GL thread since the last call. Collected
+    // first, callbacks may load more textures.
+    std::vector<std::shared_ptr<Request>> uploaded;
+
+    for (auto it = m_uploading.begin(); it != m_uploading.end();)
+    {
+        if (!(*it)->Uploaded)
+        {
+            ++it;
+            continue;
+        }
+
+        uploaded.emplace_back(*it);
+        it = m_uploading.erase(it);
+    }
+
+    for (const auto& request : uploaded)
+    {
+        Finish(request);
+    }
+
+    // Names can only be created on the GL thread, they are
+    // picked up by CreatePlaceholder a frame or two later
+    if (!m_generatingPlaceholders &&
+        m_freePlaceholders.size() < TEXTURE_PLACEHOLDER_RESERVE)
+    {
+        m_generatingPlaceholders = true;
+
+        commands.Execute([]()
+        {
+            auto placeholders = GeneratePlaceholders(TEXTURE_PLACEHOLDER_RESERVE);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_generatedPlaceholders.insert(
+                m_generatedPlaceholders.end(),
+                placeholders.begin(),
+                placeholders.end()
+            );
+        });
+    }
+
+    std::vector<std::shared_ptr<Request>> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t bytes = 0;
+
+        for (auto it = m_requests.begin(); it != m_requests.end();)
+        {
+            const auto& request = *it;
+
+            if (!request->Decoded)
+            {
+                ++it;
+                continue;
+            }
+
+            size_t size = (size_t)request->Width * request->Height * 4;
+
+            // The rest waits for the next frame
+            if (!ready.empty() && bytes + size > budget)
+            {
+                break;
+            }
+
+            bytes += size;
+            ready.emplace_back(request);
+            it = m_requests.erase(it);
+        }
+    }
+
+    for (const auto& request : ready)
+    {
+        // Nothing to upload, the placeholder stays
+        if (!request->Pixels)
+        {
+            Finish(request);
+            continue;
+        }
+
+        commands.Execute([request]()
+        {
+            // Wait got to it first
+            if (request->Uploaded)
+            {
+                return;
+            }
+
+            Upload(*request);
+            request->Uploaded = true;
+        });
+
+        m_uploading.emplace_back(request);
+    }
+}
+
+void TextureLoader::Wait(const std::vector<std::shared_ptr<Texture>>& textures)
+{
+    // Replays happen on this thread too while it has the context, so
+    // nothing below races the GL thread
+    if (!glfwGetCurrentContext())
+    {
+        Log::Critical("[TextureLoader] Wait needs the context on the calling thread");
+    }
+
+    auto waited = [&textures](const std::shared_ptr<Request>& request)
+    {
+        return std::find(
+            textures.begin(),
+            textures.end(),
+            request->Target) != textures.end();
+    };
+
+    // Recorded but maybe not replayed yet, uploaded here instead
+    std::vector<std::shared_ptr<Request>> recorded;
+
+    for (auto it = m_uploading.begin(); it != m_uploading.end();)
+    {
+        if (!waited(*it))
+        {
+            ++it;
+            continue;
+        }
+
+        recorded.emplace_back(*it);
+        it = m_uploading.erase(it);
+    }
+
+    for (const auto& request : recorded)
+    {
+        if (!request->Uploaded)
+        {
+            Upload(*request);
+            request->Uploaded = true;
+        }
+
+        Finish(request);
+    }
+
+    while (true)
+    {
+        std::shared_ptr<Request> ready;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            bool pending = false;
+
+            for (auto it = m_requests.begin(); it != m_requests.end(); ++it)
+            {
+                const auto& request = *it;
+
+                if (!waited(request))
+                {
+                    continue;
+                }
+
+                if (request->Decoded)
+                {
+                    ready = request;
+                    m_requests.erase(it);
+                    break;
+                }
+
+                pending = true;
+            }
+
+            if (!ready)
+            {
+                if (!pending)
+                {
+                    return;
+                }
+
+                m_decodedCondition.wait(lock);
+                continue;
+            }
+        }
+
+        if (ready->Pixels)
+        {
+            Upload(*ready);
+        }
+
+        Finish(ready);
+    }
+}
+
+int TextureLoader::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return (int)(m_requests.size() + m_uploading.size());
+}
+
+uint64_t TextureLoader::HashImage(const std::string& path)
+{
+    MappedFile file;
+
+    if (!file.Open(path) &&
+        !file.Open(CookedTexture::GetCookedPath(path)))
+    {
+        return 0;
+    }
+
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const unsigned char* data = file.GetData();
+
+    for (size_t i = 0; i < file.GetSize(); i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+void TextureLoader::WorkerLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<Request> request;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_queueCondition.wait(lock, []()
+            {
+                return m_stop || !m_queue.empty();
+            });
+
+            if (m_stop)
+            {
+                return;
+            }
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        // Identifies the content, so the owner can share it between paths
+        uint64_t hash = HashImage(request->Path);
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        glm::ivec2 divisions = glm::ivec2(1);
+        GLenum internalFormat = GL_RGBA;
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        const unsigned char* pixels = nullptr;
+
+        // Cooked images only need mapping
+        auto cooked = CookedTexture::Open(request->Path);
+
+        if (cooked)
+        {
+            const CookedTextureHeader& header = cooked->GetHeader();
+
+            width = (int)header.Width;
+            height = (int)header.Height;
+            divisions = glm::ivec2(header.DivisionsX, header.DivisionsY);
+            internalFormat = header.InternalFormat;
+            format = header.Format;
+            type = header.Type;
+            pixels = cooked->GetTexels();
+        }
+        else
+        {
+            // Images are always expanded to RGBA
+            pixels = stbi_load(
+                request->Path.c_str(),
+                &width,
+                &height,
+                &channels,
+                STBI_rgb_alpha
+            );
+        }
+
+        if (!pixels)
+        {
+            Log::Warning(
+                "[TextureLoader] Unable to decode %s: %s",
+                request->Path.c_str(),
+                stbi_failure_reason()
+            );
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            request->Pixels = pixels;
+            request->Width = pixels ? width : 0;
+            request->Height = pixels ? height : 0;
+            request->Divisions = divisions;
+            request->InternalFormat = internalFormat;
+            request->Format = format;
+            request->Type = type;
+            request->Cooked = std::move(cooked);
+            request->Hash = hash;
+            request->Decoded = true;
+
+            // Nobody is left to upload it
+            if (request->Cancelled)
+            {
+                ReleasePixels(*request);
+            }
+        }
+
+        m_decodedCondition.notify_all();
+    }
+}
+
+void TextureLoader::Finish(const std::shared_ptr<Request>& request)
+{
+    // Failed decodes keep the placeholder's size
+    if (request->Width > 0)
+    {
+        request->Target->Width = request->Width;
+        request->Target->Height = request->Height;
+        request->Target->Divisions = request->Divisions;
+        request->Target->InternalFormat = (int)request->InternalFormat;
+        request->Target->ImageFormat = (int)request->Format;
+    }
+
+    if (request->OnHashed)
+    {
+        request->OnHashed(request->Target, request->Hash);
+    }
+
+    if (request->OnLoaded)
+    {
+        request->OnLoaded(request->Target);
+    }
+}
+
+void TextureLoader::Upload(Request& request)
+{
+    Texture& texture = *request.Target;
+    size_t size = (size_t)request.Width * request.Height * 4;
+
+    if (m_PBO == 0)
+    {
+        glGenBuffers(1, &m_PBO);
+    }
+
+    GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PBO);
+
+    // Orphaned, so this never waits on the previous upload
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+    void* mapped = glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER,
+        0,
+        size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+    );
+
+    if (mapped)
+    {
+        std::memcpy(mapped, request.Pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Sourced from the bound PBO, the driver copies it later
+        GLState::BindTexture(0, texture.ID);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            request.InternalFormat,
+            request.Width,
+            request.Height,
+            0,
+            request.Format,
+            request.Type,
+            nullptr
+        );
+
+        GLTrace::RecordUpload(size);
+    }
+    else
+    {
+        Log::Warning(
+            "[TextureLoader] Unable to map the upload buffer for %s",
+            request.Path.c_str()
+        );
+    }
+
+    // Later glTexImage2D calls read from client memory again
+    GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    ReleasePixels(request);
+}
+
+void TextureLoader::ReleasePixels(Request& request)
+{
+    if (request.Cooked)
+    {
+        request.Cooked.reset();
+    }
+    else
+    {
+        stbi_image_free((void*)request.Pixels);
+    }
+
+    request.Pixels = nullptr;
+}
+
+std::vector<unsigned int> TextureLoader::GeneratePlaceholders(size_t count)
+{
+    std::vector<unsigned int> placeholders(count);
+    glGenTextures((GLsizei)count, placeholders.data());
+
+    // Transparent until the real image is uploaded
+    const unsigned char pixel[4] = { 0, 0, 0, 0 };
+
+    for (unsigned int placeholder : placeholders)
+    {
+        GLState::BindTexture(0, placeholder);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RGBA,
+            1,
+            1,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            pixel
+        );
+
+        // Texture's defaults
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    GLState::BindTexture(0, 0);
+
+    return placeholders;
+}
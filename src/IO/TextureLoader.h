@@ -0,0 +1,158 @@
+#pragma once
+
+#include "IO/CookedTexture.h"
+#include "Rendering/CommandList.h"
+#include "Rendering/Texture.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Upper bound on decoding threads, fewer on smaller machines
+#define TEXTURE_LOADER_WORKERS      4
+
+// Pixel bytes uploaded per frame, at least one texture always goes
+#define TEXTURE_UPLOAD_BUDGET       (4 * 1024 * 1024)
+
+// Placeholder names kept at hand, since new ones can only be
+// created on the GL thread
+#define TEXTURE_PLACEHOLDER_RESERVE 32
+
+typedef std::function<void(const std::shared_ptr<Texture>&)> TextureLoadCallback;
+typedef std::function<void(const std::shared_ptr<Texture>&, uint64_t)> TextureHashCallback;
+
+// Decodes images on worker threads and uploads them through a pixel
+// buffer object, a few per frame. Textures are handed out before
+// that as a transparent 1x1 placeholder, which keeps its ID.
+class TextureLoader
+{
+public:
+    static void Init(int workerCount = TEXTURE_LOADER_WORKERS);
+    static void Destroy();
+
+    // A transparent 1x1 texture to hand out while loading, taken
+    // from names made on the GL thread so any thread may call it
+    [[nodiscard]]
+    static std::shared_ptr<Texture> CreatePlaceholder();
+
+    // `texture` must already exist, it is resized once uploaded.
+    // `onLoaded` runs on the recording thread from the first Update
+    // after the upload has been replayed on the GL thread, or with
+    // the placeholder kept if decoding failed. `onHashed` gets the
+    // HashImage() of the file, worked out by the decoding thread,
+    // just before `onLoaded`.
+    static void Load(
+        const std::shared_ptr<Texture>& texture,
+        const std::string& path,
+        TextureLoadCallback onLoaded = nullptr,
+        TextureHashCallback onHashed = nullptr
+    );
+
+    // Forgets a texture still being loaded, nothing is called back.
+    // An upload already recorded still runs.
+    static void Cancel(const std::shared_ptr<Texture>& texture);
+
+    // Also calls `onLoaded` for a texture still being loaded,
+    // false if it isn't
+    static bool AddCallback(
+        const std::shared_ptr<Texture>& texture,
+        TextureLoadCallback onLoaded
+    );
+
+    // Records uploads of decoded images, up to `budget` bytes,
+    // finishes the ones replayed since the last call and tops up
+    // the placeholder names
+    static void Update(
+        CommandList& commands,
+        size_t budget = TEXTURE_UPLOAD_BUDGET
+    );
+
+    // Blocks until the textures are decoded and uploads them right
+    // away, along with uploads recorded but not replayed yet. Needs
+    // the context on the calling thread (Game::Init, in-line rendering).
+    static void Wait(const std::vector<std::shared_ptr<Texture>>& textures);
+
+    // Textures not uploaded (or not finished) yet
+    [[nodiscard]]
+    static int GetPendingCount();
+
+    // FNV-1a of the image file (or its cooked twin if the source
+    // is not shipped), 0 if neither can be read
+    [[nodiscard]]
+    static uint64_t HashImage(const std::string& path);
+
+private:
+    struct Request
+    {
+        std::shared_ptr<Texture> Target;
+        std::string Path;
+        TextureLoadCallback OnLoaded;
+        TextureHashCallback OnHashed;
+
+        // Written by the worker that decoded it, no size if it failed
+        const unsigned char* Pixels = nullptr;
+        int Width = 0;
+        int Height = 0;
+        glm::ivec2 Divisions = glm::ivec2(1);
+        uint64_t Hash = 0;
+
+        // From the cooked header, else what stb_image expands to
+        GLenum InternalFormat = GL_RGBA;
+        GLenum Format = GL_RGBA;
+        GLenum Type = GL_UNSIGNED_BYTE;
+        bool Decoded = false;
+
+        // Dropped while a worker had it, the result is thrown away
+        bool Cancelled = false;
+
+        // Set by the replayed upload, finished by the next Update
+        std::atomic<bool> Uploaded = false;
+
+        // Owns Pixels if the image was cooked, else stb_image does
+        std::unique_ptr<CookedTexture> Cooked;
+    };
+
+    static void WorkerLoop();
+
+    // Recording side: sizes the texture and calls back
+    static void Finish(const std::shared_ptr<Request>& request);
+
+    // GL side: copies the pixels through the PBO
+    static void Upload(Request& request);
+
+    static void ReleasePixels(Request& request);
+
+    // GL side: creates `count` placeholders
+    static std::vector<unsigned int> GeneratePlaceholders(size_t count);
+
+    static std::vector<std::thread> m_workers;
+    static std::mutex m_mutex;
+    static std::condition_variable m_queueCondition;
+    static std::condition_variable m_decodedCondition;
+    static bool m_stop;
+
+    // Waiting for a worker
+    static std::deque<std::shared_ptr<Request>> m_queue;
+
+    // Not uploaded yet, in load order
+    static std::vector<std::shared_ptr<Request>> m_requests;
+
+    // Upload recorded but not finished, only touched on the recording thread
+    static std::vector<std::shared_ptr<Request>> m_uploading;
+
+    // Placeholders ready to hand out, only touched on the recording
+    // thread, and the ones the GL thread made since (under m_mutex)
+    static std::vector<unsigned int> m_freePlaceholders;
+    static std::vector<unsigned int> m_generatedPlaceholders;
+    static bool m_generatingPlaceholders;
+
+    // Orphaned on every upload, only touched on the GL thread
+    static unsigned int m_PBO;
+};
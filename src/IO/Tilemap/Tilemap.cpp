@@ -2,6 +2,8 @@
 
 #include "Core/Log.h"
 #include "Core/Scene/Components.h"
+#include "IO/ResourceManager.h"
+#include "Rendering/GLState.h"
 
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -13,14 +15,69 @@ const unsigned FLIPPED_VERTICALLY_FLAG    = 0x40000000;
 const unsigned FLIPPED_DIAGONALLY_FLAG    = 0x20000000;
 const unsigned ROTATED_HEXAGONAL_120_FLAG = 0x10000000;
 
+// Decodes Tiled's base64 layer encoding into little-endian GIDs
+static std::vector<uint32_t> DecodeBase64Layer(const std::string& text)
+{
+    static const std::string alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    int lookup[256];
+    std::fill(std::begin(lookup), std::end(lookup), -1);
+
+    for (int i = 0; i < (int)alphabet.size(); i++)
+    {
+        lookup[(unsigned char)alphabet[i]] = i;
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(text.size() / 4 * 3);
+
+    uint32_t buffer = 0;
+    int bits = 0;
+
+    for (char c : text)
+    {
+        int value = lookup[(unsigned char)c];
+
+        // Skip padding and whitespace
+        if (value == -1)
+        {
+            continue;
+        }
+
+        buffer = (buffer << 6) | (uint32_t)value;
+        bits += 6;
+
+        if (bits >= 8)
+        {
+            bits -= 8;
+            bytes.push_back((uint8_t)((buffer >> bits) & 0xFF));
+        }
+    }
+
+    std::vector<uint32_t> gids(bytes.size() / 4);
+
+    for (size_t i = 0; i < gids.size(); i++)
+    {
+        gids[i] = bytes[i * 4] |
+                  bytes[i * 4 + 1] << 8  |
+                  bytes[i * 4 + 2] << 16 |
+                  (uint32_t)bytes[i * 4 + 3] << 24;
+    }
+
+    return gids;
+}
+
 Tilemap::Tilemap(
     const std::shared_ptr<Scene>& scene,
     const char* path,
     const std::vector<TilemapInput>& tilemaps,
-    int pixelsPerUnit)
+    int pixelsPerUnit,
+    ETilemapRenderMode renderMode)
 {
     m_scene = scene;
     m_pixelsPerUnit = pixelsPerUnit;
+    m_renderMode = renderMode;
 
     // Parse JSON file
     std::ifstream file(path);
@@ -51,6 +108,15 @@ Tilemap::Tilemap(
         );
     }
 
+    if (m_renderMode == ETilemapRenderMode::GPULayers &&
+        tilemaps.size() > TILEMAP_MAX_TILESETS)
+    {
+        Log::Critical(
+            "GPU tilemap layers support at most %i tilesets!",
+            TILEMAP_MAX_TILESETS
+        );
+    }
+
     // Get tilesets and match them to their TileSprites
     m_tileSets.reserve(tilemaps.size());
     int tilesetIndex = 0;
@@ -65,15 +131,16 @@ Tilemap::Tilemap(
         tileset.TilemapData = tilemaps[tilesetIndex];
         tileset.Length = tilemaps[tilesetIndex].Dimensions.x *
             tilemaps[tilesetIndex].Dimensions.y;
-        
+        tileset.UVRect = tilemaps[tilesetIndex].Region.GetUVRect();
+
         m_tileSets.emplace_back(tileset);
-        
+
         tilesetIndex++;
     }
 
     // Get layers
     m_tileLayers.clear();
-    
+
     int layerID = 0;
 
     for (json::iterator it = data["layers"].begin();
@@ -85,165 +152,889 @@ Tilemap::Tilemap(
         layer.Name = it.value()["name"];
         layer.Width = it.value()["width"];
         layer.Height = it.value()["height"];
-        
-        std::vector<uint32_t> entries = it.value()["data"];
-        auto* tileData = reinterpret_cast<unsigned char*>(entries.data());
-        
-        std::vector<Entity> tileEntities;
-        tileEntities.reserve(entries.size());
 
-        for (int i = 0; i < layer.Width; i ++)
+        // Large maps are stored base64 encoded (uncompressed only)
+        if (it.value().value("encoding", "csv") == "base64")
         {
-            for (int j = 0; j < layer.Height; j++)
+            if (!it.value().value("compression", "").empty())
             {
-                int tileIndex = (j * layer.Width + i) * 4;
-                
-                // Read the GID in little-endian byte order:
-                int tileID = tileData[tileIndex] |
-                             tileData[tileIndex + 1] << 8  |
-                             tileData[tileIndex + 2] << 16 |
-                             tileData[tileIndex + 3] << 24;
-
-                bool flippedH = (tileID & FLIPPED_HORIZONTALLY_FLAG);
-                bool flippedV = (tileID & FLIPPED_VERTICALLY_FLAG);
-                bool flippedDiag = (tileID & FLIPPED_DIAGONALLY_FLAG);
-
-                // Clear flags (Even the ones we are not using)
-                tileID &= ~(FLIPPED_HORIZONTALLY_FLAG |
-                            FLIPPED_VERTICALLY_FLAG |
-                            FLIPPED_DIAGONALLY_FLAG |
-                            ROTATED_HEXAGONAL_120_FLAG
+                Log::Critical(
+                    "Compressed tilemap layers are not supported!"
                 );
-                
-                if (tileID == 0)
-                {
-                    // No tile entity needs to be instantiated
-                    // if its tileID = 0
-                    continue;
-                }
-                
-                // Find correct tilemap input
-                int foundTilemap = (int)m_tileSets.size() - 1;
-                int foundTile = m_tileSets[foundTilemap].Length - 1;
-                
-                for (int k = 0; k < m_tileSets.size() - 1; k++)
-                {
-                    if (m_tileSets[k].FirstGID <= tileID &&
-                        m_tileSets[k + 1].FirstGID > tileID)
-                    {
-                        foundTile = (int)tileID - m_tileSets[k].FirstGID;
-                        foundTilemap = k;
-                        break;
-                    }
-                }
-                
-                // Create scene entity
-                
-                Entity result = m_scene.lock()->CreateEntity(
-                    std::format(
-                        "Layer{}Tile{}",
-                        layerID,
-                        j * layer.Width + i)
-                );
-                
-                auto& transform = result.GetComponent<TransformComponent>();
-                
-                transform.Position = glm::vec2(
-                    m_tileFootprint * (float)i,
-                    m_tileFootprint * (float)j
-                );
-                transform.Size = glm::vec2(m_tileFootprint);
-                
-                auto& spriteRenderer = result.AddComponent<SpriteRendererComponent>();
-                
-                spriteRenderer.SetTexture(tilemaps[foundTilemap].Texture);
-                spriteRenderer.FlipHorizontal = flippedH;
-                spriteRenderer.FlipVertical = flippedV;
-                spriteRenderer.FlipDiagonal = flippedDiag;
-                
-                auto& tileComponent = result.AddComponent<TileComponent>(
-                    tilemaps[foundTilemap].Dimensions
-                );
-                
-                tileComponent.TileIndex = foundTile;
-                
-                tileEntities.emplace_back(result);
             }
+
+            layer.Data = DecodeBase64Layer(it.value()["data"]);
+        }
+        else
+        {
+            layer.Data = it.value()["data"].get<std::vector<uint32_t>>();
+        }
+
+        if (layer.Data.size() != (size_t)layer.Width * layer.Height)
+        {
+            Log::Critical(
+                "Tilemap layer '%s' has %zu tiles, expected %i!",
+                layer.Name.c_str(),
+                layer.Data.size(),
+                layer.Width * layer.Height
+            );
+        }
+
+        if (m_renderMode == ETilemapRenderMode::GPULayers)
+        {
+            CreateLayerTexture(layer);
+        }
+        else if (m_renderMode == ETilemapRenderMode::Entities)
+        {
+            CreateTileEntities(layer, layerID);
         }
 
-        layer.TileEntities = tileEntities;
-        m_tileLayers.emplace_back(layer);
-        
+        m_tileLayers.emplace_back(std::move(layer));
+
         layerID += 1;
     }
+
+    if (m_renderMode == ETilemapRenderMode::GPULayers)
+    {
+        SetupLayerRendering();
+    }
+    else if (m_renderMode == ETilemapRenderMode::Chunks)
+    {
+        SetupChunkRendering();
+    }
 }
 
-void Tilemap::Draw(std::shared_ptr<Camera> &camera)
+Tilemap::~Tilemap()
 {
-    // Draw all tiles in right-down order
-    /*for (TileLayer layer : m_tileLayers)
+    if (m_buildThread.joinable())
     {
-        for (int i = 0; i < layer.Width; i++)
         {
-            for (int j = 0; j < layer.Height; j++)
+            std::lock_guard lock(m_buildMutex);
+            m_stopBuilding = true;
+        }
+
+        m_buildCondition.notify_all();
+        m_buildThread.join();
+    }
+
+    for (auto& [key, chunk] : m_chunks)
+    {
+        ReleaseChunk(chunk);
+    }
+
+    m_freeBuffers.insert(
+        m_freeBuffers.end(),
+        m_generatedBuffers.begin(),
+        m_generatedBuffers.end()
+    );
+
+    for (unsigned int buffer : m_freeBuffers)
+    {
+        GLState::DeleteBuffer(buffer);
+    }
+
+    if (m_chunkVAO != 0)
+    {
+        GLState::DeleteVertexArray(m_chunkVAO);
+    }
+
+    for (TileLayer& layer : m_tileLayers)
+    {
+        if (layer.DataTexture != 0)
+        {
+            GLState::DeleteTexture(layer.DataTexture);
+        }
+    }
+
+    if (m_quadVAO != 0)
+    {
+        GLState::DeleteVertexArray(m_quadVAO);
+        GLState::DeleteBuffer(m_quadVBO);
+    }
+}
+
+void Tilemap::CreateTileEntities(TileLayer& layer, int layerID)
+{
+    std::vector<Entity> tileEntities;
+    tileEntities.reserve(layer.Data.size());
+
+    for (int i = 0; i < layer.Width; i ++)
+    {
+        for (int j = 0; j < layer.Height; j++)
+        {
+            uint32_t tileID = layer.Data[j * layer.Width + i];
+
+            bool flippedH = (tileID & FLIPPED_HORIZONTALLY_FLAG);
+            bool flippedV = (tileID & FLIPPED_VERTICALLY_FLAG);
+            bool flippedDiag = (tileID & FLIPPED_DIAGONALLY_FLAG);
+
+            // Clear flags (Even the ones we are not using)
+            tileID &= ~(FLIPPED_HORIZONTALLY_FLAG |
+                        FLIPPED_VERTICALLY_FLAG |
+                        FLIPPED_DIAGONALLY_FLAG |
+                        ROTATED_HEXAGONAL_120_FLAG
+            );
+
+            if (tileID == 0)
             {
-                int index = j * layer.Width + i;
+                // No tile entity needs to be instantiated
+                // if its tileID = 0
+                continue;
+            }
+
+            // Find correct tilemap input
+            int foundTilemap = (int)m_tileSets.size() - 1;
+            int foundTile = m_tileSets[foundTilemap].Length - 1;
 
-                // 0 = no tile
-                if (layer.Tiles[index].ID == 0)
+            for (int k = 0; k < m_tileSets.size() - 1; k++)
+            {
+                if (m_tileSets[k].FirstGID <= tileID &&
+                    m_tileSets[k + 1].FirstGID > tileID)
                 {
-                    continue;
+                    foundTile = (int)tileID - m_tileSets[k].FirstGID;
+                    foundTilemap = k;
+                    break;
                 }
+            }
 
-                int tileID = layer.Tiles[index].ID;
+            const TilemapInput& tilemap = m_tileSets[foundTilemap].TilemapData;
 
-                int tilesetIndex = 0;
-                int tileIndex = 0;
+            // Create scene entity
+
+            Entity result = m_scene.lock()->CreateEntity(
+                std::format(
+                    "Layer{}Tile{}",
+                    layerID,
+                    j * layer.Width + i)
+            );
+
+            auto& transform = result.GetComponent<TransformComponent>();
+
+            transform.Position = glm::vec2(
+                m_tileFootprint * (float)i,
+                m_tileFootprint * (float)j
+            );
+            transform.Size = glm::vec2(m_tileFootprint);
+
+            auto& spriteRenderer = result.AddComponent<SpriteRendererComponent>();
+
+            spriteRenderer.SetTexture(tilemap.Region);
+            spriteRenderer.Layer = (uint8_t)(ERenderLayer::Tiles + layerID);
+            spriteRenderer.FlipHorizontal = flippedH;
+            spriteRenderer.FlipVertical = flippedV;
+            spriteRenderer.FlipDiagonal = flippedDiag;
+
+            auto& tileComponent = result.AddComponent<TileComponent>(
+                tilemap.Dimensions
+            );
+
+            tileComponent.TileIndex = foundTile;
+
+            tileEntities.emplace_back(result);
+        }
+    }
+
+    layer.TileEntities = tileEntities;
+}
+
+void Tilemap::CreateLayerTexture(TileLayer& layer)
+{
+    // One texel per cell, holding the raw GID and flip flags.
+    // Tileset lookup and flip decoding happen in tilemap.frag.
+    glGenTextures(1, &layer.DataTexture);
+    GLState::BindTexture(0, layer.DataTexture);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_R32UI,
+        layer.Width,
+        layer.Height,
+        0,
+        GL_RED_INTEGER,
+        GL_UNSIGNED_INT,
+        layer.Data.data()
+    );
+
+    // Integer textures can't be filtered
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLState::BindTexture(0, 0);
+}
+
+void Tilemap::SetupLayerRendering()
+{
+    m_layerShader = ResourceManager::LoadShader(
+        "res/shaders/tilemap.vert",
+        "res/shaders/tilemap.frag",
+        "TilemapShader"
+    );
+
+    m_layerDataUniform = m_layerShader->GetUniform<int>("layerData");
+    m_layerSizeUniform = m_layerShader->GetUniform<glm::vec2>("layerSize");
+    m_layerWorldSizeUniform =
+        m_layerShader->GetUniform<glm::vec2>("layerWorldSize");
+
+    // Tilesets never change, so their uniforms are only set once.
+    // Unit 0 holds the layer data, tilesets use units 1..N.
+    m_layerShader->Use();
+    m_layerShader->SetInt("tilesetCount", (int)m_tileSets.size());
+
+    for (int i = 0; i < m_tileSets.size(); i++)
+    {
+        const Tileset& tileset = m_tileSets[i];
+
+        m_layerShader->SetInt(
+            std::format("tilesets[{}]", i).c_str(),
+            1 + i
+        );
+        m_layerShader->SetInt(
+            std::format("tilesetFirstGID[{}]", i).c_str(),
+            tileset.FirstGID
+        );
+        m_layerShader->SetVec2(
+            std::format("tilesetDivisions[{}]", i).c_str(),
+            glm::vec2(tileset.TilemapData.Dimensions)
+        );
+        m_layerShader->SetVec4(
+            std::format("tilesetRects[{}]", i).c_str(),
+            tileset.UVRect
+        );
+    }
+
+    // Unit quad, scaled to the layer size in the vertex shader
+    float vertices[] =
+    {
+        // Pos      // UV
+        0.0F, 1.0F, 0.0F, 1.0F,
+        1.0F, 0.0F, 1.0F, 0.0F,
+        0.0F, 0.0F, 0.0F, 0.0F,
+
+        0.0F, 1.0F, 0.0F, 1.0F,
+        1.0F, 1.0F, 1.0F, 1.0F,
+        1.0F, 0.0F, 1.0F, 0.0F
+    };
+
+    glGenVertexArrays(1, &m_quadVAO);
+    glGenBuffers(1, &m_quadVBO);
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        sizeof(vertices),
+        vertices,
+        GL_STATIC_DRAW
+    );
+
+    GLState::BindVertexArray(m_quadVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+        0,
+        4,
+        GL_FLOAT,
+        GL_FALSE,
+        4 * sizeof(float),
+        (void*)nullptr
+    );
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+}
+
+void Tilemap::Draw(
+    std::shared_ptr<Camera>& camera,
+    CommandList& commands)
+{
+    // Entity tiles are drawn by the Renderer
+    if (m_renderMode == ETilemapRenderMode::GPULayers)
+    {
+        DrawLayers(commands);
+    }
+    else if (m_renderMode == ETilemapRenderMode::Chunks)
+    {
+        DrawChunks(camera->GetWorldBounds(), commands);
+    }
+}
+
+void Tilemap::DrawLayers(CommandList& commands)
+{
+    for (const TileUpdate& update : m_tileUpdates)
+    {
+        commands.UpdateTexture(
+            m_tileLayers[update.Layer].DataTexture,
+            glm::ivec4(update.X, update.Y, 1, 1),
+            GL_RED_INTEGER,
+            GL_UNSIGNED_INT,
+            &update.GID,
+            sizeof(uint32_t)
+        );
+    }
+
+    m_tileUpdates.clear();
+
+    commands.UseProgram(m_layerShader->ID);
+    commands.SetUniform(m_layerDataUniform, 0);
+
+    for (int i = 0; i < m_tileSets.size(); i++)
+    {
+        commands.BindTexture(
+            1 + i,
+            m_tileSets[i].TilemapData.Region.Page->ID
+        );
+    }
+
+    commands.BindVertexArray(m_quadVAO);
+
+    // One draw per layer, in file order
+    for (const TileLayer& layer : m_tileLayers)
+    {
+        commands.SetUniform(
+            m_layerSizeUniform,
+            glm::vec2(layer.Width, layer.Height)
+        );
+        commands.SetUniform(
+            m_layerWorldSizeUniform,
+            glm::vec2(layer.Width, layer.Height) * m_tileFootprint
+        );
+
+        commands.BindTexture(0, layer.DataTexture);
+        commands.DrawArrays(GL_TRIANGLES, 0, 6);
+    }
+}
+
+void Tilemap::SetTile(int layer, int x, int y, uint32_t gid)
+{
+    TileLayer& tileLayer = m_tileLayers[layer];
+
+    if (x < 0 || y < 0 || x >= tileLayer.Width || y >= tileLayer.Height)
+    {
+        Log::Warning(
+            "[Tilemap] Tile [%i, %i] is outside of layer '%s'!",
+            x,
+            y,
+            tileLayer.Name.c_str()
+        );
+        return;
+    }
+
+    if (m_renderMode == ETilemapRenderMode::Entities)
+    {
+        Log::Warning(
+            "[Tilemap] SetTile is not supported for entity tiles!"
+        );
+        return;
+    }
+
+    tileLayer.Data[y * tileLayer.Width + x] = gid;
+
+    if (m_renderMode == ETilemapRenderMode::Chunks)
+    {
+        // Rebuilt by DrawChunks() if the chunk is (or becomes) resident
+        m_dirtyChunks.insert(MakeChunkKey(
+            layer,
+            x / TILEMAP_CHUNK_SIZE,
+            y / TILEMAP_CHUNK_SIZE
+        ));
+        return;
+    }
+
+    // Single texel update, recorded by the next DrawLayers()
+    m_tileUpdates.push_back({ layer, x, y, gid });
+}
+
+uint32_t Tilemap::GetTile(int layer, int x, int y) const
+{
+    const TileLayer& tileLayer = m_tileLayers[layer];
+
+    if (x < 0 || y < 0 || x >= tileLayer.Width || y >= tileLayer.Height)
+    {
+        Log::Warning(
+            "[Tilemap] Tile [%i, %i] is outside of layer '%s'!",
+            x,
+            y,
+            tileLayer.Name.c_str()
+        );
+        return 0;
+    }
+
+    return tileLayer.Data[y * tileLayer.Width + x];
+}
+
+const TilemapStats& Tilemap::GetStats() const
+{
+    return m_stats;
+}
+
+uint64_t Tilemap::MakeChunkKey(int layer, int x, int y)
+{
+    return ((uint64_t)layer << 48) |
+           ((uint64_t)(y & 0xFFFFFF) << 24) |
+           (uint64_t)(x & 0xFFFFFF);
+}
 
-                for (const Tileset& tileset : m_tileSets)
+void Tilemap::SetupChunkRendering()
+{
+    m_chunkShader = ResourceManager::LoadShader(
+        "res/shaders/tile_chunk.vert",
+        "res/shaders/tile_chunk.frag",
+        "TileChunkShader"
+    );
+
+    m_chunkShader->Use();
+    m_chunkShader->SetInt("image", 0);
+
+    // Shared by every chunk, meshes only bind their own buffer
+    glGenVertexArrays(1, &m_chunkVAO);
+    GLState::BindVertexArray(m_chunkVAO);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(0, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+
+    GLState::BindVertexArray(0);
+
+    // Enough for the first chunks, before the GL thread runs
+    m_freeBuffers.resize(TILEMAP_CHUNK_BUFFER_RESERVE);
+    glGenBuffers((GLsizei)m_freeBuffers.size(), m_freeBuffers.data());
+
+    m_buildThread = std::thread(&Tilemap::BuildThreadLoop, this);
+}
+
+void Tilemap::DrawChunks(const glm::vec4& bounds, CommandList& commands)
+{
+    m_stats.DrawnChunks = 0;
+    m_stats.UploadedChunks = 0;
+
+    ReserveBuffers(commands);
+
+    // Range of chunks to keep resident: the visible ones plus a margin
+    float chunkWorldSize = (float)TILEMAP_CHUNK_SIZE * m_tileFootprint;
+
+    glm::ivec2 visibleMin = glm::ivec2(glm::floor(
+        glm::vec2(bounds.x, bounds.y) / chunkWorldSize
+    ));
+    glm::ivec2 visibleMax = glm::ivec2(glm::floor(
+        glm::vec2(bounds.z, bounds.w) / chunkWorldSize
+    ));
+
+    glm::ivec2 keepMin = visibleMin - TILEMAP_CHUNK_MARGIN;
+    glm::ivec2 keepMax = visibleMax + TILEMAP_CHUNK_MARGIN;
+
+    auto isKept = [&](uint64_t key)
+    {
+        int x = (int)(key & 0xFFFFFF);
+        int y = (int)((key >> 24) & 0xFFFFFF);
+
+        return x >= keepMin.x && x <= keepMax.x &&
+               y >= keepMin.y && y <= keepMax.y;
+    };
+
+    // Free chunks outside of the kept range
+    std::erase_if(m_chunks, [&](auto& entry)
+    {
+        if (isKept(entry.first))
+        {
+            return false;
+        }
+
+        ReleaseChunk(entry.second);
+        return true;
+    });
+
+    // Upload a bounded number of finished builds
+    std::vector<ChunkResult> results;
+
+    {
+        std::lock_guard lock(m_buildMutex);
+
+        while (!m_buildResults.empty() &&
+               results.size() < TILEMAP_CHUNK_UPLOADS_PER_FRAME)
+        {
+            results.emplace_back(std::move(m_buildResults.back()));
+            m_buildResults.pop_back();
+        }
+
+        // Drop queued builds the camera has moved away from
+        std::erase_if(m_buildJobs, [&](const ChunkJob& job)
+        {
+            if (isKept(job.Key))
+            {
+                return false;
+            }
+
+            m_pendingChunks.erase(job.Key);
+            return true;
+        });
+    }
+
+    // Builds there are no free buffers for yet wait a frame
+    std::vector<ChunkResult> deferred;
+
+    for (ChunkResult& result : results)
+    {
+        if (!isKept(result.Key))
+        {
+            m_pendingChunks.erase(result.Key);
+            continue;
+        }
+
+        size_t needed = 0;
+        size_t released = 0;
+
+        for (const auto& vertices : result.Vertices)
+        {
+            needed += vertices.empty() ? 0 : 1;
+        }
+
+        // A rebuild hands back the previous meshes first
+        auto existing = m_chunks.find(result.Key);
+
+        if (existing != m_chunks.end())
+        {
+            released = existing->second.Meshes.size();
+        }
+
+        if (m_freeBuffers.size() + released < needed)
+        {
+            deferred.emplace_back(std::move(result));
+            continue;
+        }
+
+        m_pendingChunks.erase(result.Key);
+
+        UploadChunk(result, commands);
+        m_stats.UploadedChunks += 1;
+    }
+
+    if (!deferred.empty())
+    {
+        std::lock_guard lock(m_buildMutex);
+
+        m_buildResults.insert(
+            m_buildResults.end(),
+            std::make_move_iterator(deferred.begin()),
+            std::make_move_iterator(deferred.end())
+        );
+    }
+
+    commands.UseProgram(m_chunkShader->ID);
+    commands.BindVertexArray(m_chunkVAO);
+
+    for (int layer = 0; layer < (int)m_tileLayers.size(); layer++)
+    {
+        const TileLayer& tileLayer = m_tileLayers[layer];
+
+        glm::ivec2 layerChunks = (glm::ivec2(
+            tileLayer.Width,
+            tileLayer.Height
+        ) + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+
+        glm::ivec2 first = glm::max(keepMin, glm::ivec2(0));
+        glm::ivec2 last = glm::min(keepMax, layerChunks - 1);
+
+        for (int y = first.y; y <= last.y; y++)
+        {
+            for (int x = first.x; x <= last.x; x++)
+            {
+                uint64_t key = MakeChunkKey(layer, x, y);
+                auto it = m_chunks.find(key);
+
+                if (it == m_chunks.end() || m_dirtyChunks.contains(key))
                 {
-                    if (tileset.FirstGID <= tileID &&
-                        tileset.FirstGID + tileset.Length + 1 >= tileID)
+                    if (!m_pendingChunks.contains(key))
+                    {
+                        RequestChunk(layer, x, y);
+                    }
+
+                    if (it == m_chunks.end())
                     {
-                        tileIndex = tileID - tileset.FirstGID;
-                        break;
+                        continue;
                     }
+                }
 
-                    tilesetIndex += 1;
+                // Margin chunks are only prefetched
+                if (x < visibleMin.x || x > visibleMax.x ||
+                    y < visibleMin.y || y > visibleMax.y)
+                {
+                    continue;
                 }
 
-                const auto& tileSprite = m_tileSets[tilesetIndex].TileSprite;
+                for (const ChunkMesh& mesh : it->second.Meshes)
+                {
+                    commands.BindTexture(
+                        0,
+                        m_tileSets[mesh.Tileset].TilemapData.Region.Page->ID
+                    );
+                    commands.BindVertexBuffer(
+                        0,
+                        mesh.VBO,
+                        0,
+                        sizeof(ChunkVertex)
+                    );
+                    commands.DrawArrays(GL_TRIANGLES, 0, mesh.VertexCount);
+                }
 
-                // Position
-                tileSprite->SetPosition(glm::vec2(
-                    m_tileFootprint * (float)i,
-                    m_tileFootprint * (float)j
-                ));
+                m_stats.DrawnChunks += 1;
+            }
+        }
+    }
 
-                // Set flipping
-                tileSprite->SetFlipHorizontal(
-                    layer.Tiles[index].FlipHorizontal
-                );
-                tileSprite->SetFlipVertical(
-                    layer.Tiles[index].FlipVertical
-                );
-                tileSprite->SetFlipDiagonal(
-                    layer.Tiles[index].FlipDiagonal
-                );
+    m_stats.ResidentChunks = (int)m_chunks.size();
+    m_stats.PendingChunks = (int)m_pendingChunks.size();
+}
 
-                // Set size
-                tileSprite->SetScale(glm::vec2(m_tileFootprint));
+void Tilemap::RequestChunk(int layer, int x, int y)
+{
+    const TileLayer& tileLayer = m_tileLayers[layer];
 
-                // Draw!
-                tileSprite->SetCurrentTileIndex(
-                    tileIndex
-                );
+    ChunkJob job = {};
+    job.Key = MakeChunkKey(layer, x, y);
+    job.Origin = glm::ivec2(x, y) * TILEMAP_CHUNK_SIZE;
+    job.Size = glm::min(
+        glm::ivec2(TILEMAP_CHUNK_SIZE),
+        glm::ivec2(tileLayer.Width, tileLayer.Height) - job.Origin
+    );
+
+    // Snapshot the chunk's tiles for the worker
+    job.GIDs.resize((size_t)job.Size.x * job.Size.y);
+
+    for (int row = 0; row < job.Size.y; row++)
+    {
+        const uint32_t* source = tileLayer.Data.data() +
+            (size_t)(job.Origin.y + row) * tileLayer.Width + job.Origin.x;
+
+        std::copy(
+            source,
+            source + job.Size.x,
+            job.GIDs.begin() + (size_t)row * job.Size.x
+        );
+    }
+
+    m_pendingChunks.insert(job.Key);
+    m_dirtyChunks.erase(job.Key);
+
+    {
+        std::lock_guard lock(m_buildMutex);
+        m_buildJobs.emplace_back(std::move(job));
+    }
+
+    m_buildCondition.notify_one();
+}
+
+void Tilemap::UploadChunk(ChunkResult& result, CommandList& commands)
+{
+    // Rebuilds replace the previous meshes
+    auto existing = m_chunks.find(result.Key);
+
+    if (existing != m_chunks.end())
+    {
+        ReleaseChunk(existing->second);
+    }
+
+    Chunk& chunk = m_chunks[result.Key];
+
+    for (int tileset = 0; tileset < (int)result.Vertices.size(); tileset++)
+    {
+        const auto& vertices = result.Vertices[tileset];
+
+        if (vertices.empty())
+        {
+            continue;
+        }
+
+        ChunkMesh mesh = {};
+        mesh.Tileset = tileset;
+        mesh.VBO = m_freeBuffers.back();
+        mesh.VertexCount = (int)vertices.size();
+
+        m_freeBuffers.pop_back();
+
+        // Copied into the list, replayed before this frame's draws
+        commands.BufferData(
+            GL_ARRAY_BUFFER,
+            mesh.VBO,
+            vertices.data(),
+            vertices.size() * sizeof(ChunkVertex),
+            GL_STATIC_DRAW
+        );
 
-                tileSprite->Draw(camera);
+        chunk.Meshes.emplace_back(mesh);
+    }
+}
+
+void Tilemap::ReleaseChunk(Chunk& chunk)
+{
+    for (const ChunkMesh& mesh : chunk.Meshes)
+    {
+        m_freeBuffers.emplace_back(mesh.VBO);
+    }
+
+    chunk.Meshes.clear();
+}
+
+void Tilemap::ReserveBuffers(CommandList& commands)
+{
+    {
+        std::lock_guard lock(m_bufferMutex);
+
+        if (!m_generatedBuffers.empty())
+        {
+            m_freeBuffers.insert(
+                m_freeBuffers.end(),
+                m_generatedBuffers.begin(),
+                m_generatedBuffers.end()
+            );
+
+            m_generatedBuffers.clear();
+            m_generatingBuffers = false;
+        }
+    }
+
+    if (m_generatingBuffers ||
+        m_freeBuffers.size() >= TILEMAP_CHUNK_BUFFER_RESERVE)
+    {
+        return;
+    }
+
+    m_generatingBuffers = true;
+
+    // Names can only be created on the GL thread, they are
+    // picked up here a frame or two later
+    commands.Execute([this]
+    {
+        std::vector<unsigned int> buffers(TILEMAP_CHUNK_BUFFER_RESERVE);
+        glGenBuffers((GLsizei)buffers.size(), buffers.data());
+
+        std::lock_guard lock(m_bufferMutex);
+
+        m_generatedBuffers.insert(
+            m_generatedBuffers.end(),
+            buffers.begin(),
+            buffers.end()
+        );
+    });
+}
+
+void Tilemap::BuildThreadLoop()
+{
+    while (true)
+    {
+        ChunkJob job;
 
-                // Reset tile to identity transform
-                tileSprite->ResetTransform();
+        {
+            std::unique_lock lock(m_buildMutex);
+
+            m_buildCondition.wait(lock, [this]
+            {
+                return m_stopBuilding || !m_buildJobs.empty();
+            });
+
+            if (m_stopBuilding)
+            {
+                return;
+            }
+
+            job = std::move(m_buildJobs.front());
+            m_buildJobs.pop_front();
+        }
+
+        ChunkResult result = BuildChunk(job);
+
+        std::lock_guard lock(m_buildMutex);
+        m_buildResults.emplace_back(std::move(result));
+    }
+}
+
+Tilemap::ChunkResult Tilemap::BuildChunk(const ChunkJob& job) const
+{
+    // Only reads the job and immutable tileset data, safe to
+    // run off the render thread
+    ChunkResult result = {};
+    result.Key = job.Key;
+    result.Vertices.resize(m_tileSets.size());
+
+    // Quad corners, same winding as the sprite quad
+    const glm::vec2 corners[6] =
+    {
+        { 0.0F, 1.0F }, { 1.0F, 0.0F }, { 0.0F, 0.0F },
+        { 0.0F, 1.0F }, { 1.0F, 1.0F }, { 1.0F, 0.0F }
+    };
+
+    for (int j = 0; j < job.Size.y; j++)
+    {
+        for (int i = 0; i < job.Size.x; i++)
+        {
+            uint32_t gid = job.GIDs[(size_t)j * job.Size.x + i];
+            int tileID = (int)(gid & ~(FLIPPED_HORIZONTALLY_FLAG |
+                                       FLIPPED_VERTICALLY_FLAG |
+                                       FLIPPED_DIAGONALLY_FLAG |
+                                       ROTATED_HEXAGONAL_120_FLAG));
+
+            if (tileID == 0)
+            {
+                continue;
+            }
+
+            // Tileset with the largest first GID <= tileID
+            int tileset = 0;
+
+            for (int k = 1; k < (int)m_tileSets.size(); k++)
+            {
+                if (m_tileSets[k].FirstGID <= tileID)
+                {
+                    tileset = k;
+                }
+            }
+
+            glm::ivec2 divisions = m_tileSets[tileset].TilemapData.Dimensions;
+            glm::vec4 rect = m_tileSets[tileset].UVRect;
+            int tileIndex = tileID - m_tileSets[tileset].FirstGID;
+
+            glm::vec2 tileCoords = glm::vec2(
+                tileIndex % divisions.x,
+                tileIndex / divisions.x
+            );
+
+            glm::vec2 tileOrigin = glm::vec2(
+                job.Origin.x + i,
+                job.Origin.y + j
+            ) * m_tileFootprint;
+
+            auto& vertices = result.Vertices[tileset];
+
+            for (const glm::vec2& corner : corners)
+            {
+                // Undo Tiled's flips (diagonal first, then H and V)
+                glm::vec2 local = corner;
+
+                if (gid & FLIPPED_HORIZONTALLY_FLAG)
+                {
+                    local.x = 1.0F - local.x;
+                }
+                if (gid & FLIPPED_VERTICALLY_FLAG)
+                {
+                    local.y = 1.0F - local.y;
+                }
+                if (gid & FLIPPED_DIAGONALLY_FLAG)
+                {
+                    local = glm::vec2(local.y, local.x);
+                }
+
+                ChunkVertex vertex = {};
+                vertex.Position = tileOrigin + corner * m_tileFootprint;
+                vertex.UV = glm::mix(
+                    glm::vec2(rect.x, rect.y),
+                    glm::vec2(rect.z, rect.w),
+                    (tileCoords + local) / glm::vec2(divisions)
+                );
+
+                vertices.emplace_back(vertex);
             }
         }
-    }*/
+    }
+
+    return result;
 }
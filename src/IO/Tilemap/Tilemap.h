@@ -1,18 +1,63 @@
 #pragma once
 
 #include "Rendering/Camera.h"
+#include "Rendering/CommandList.h"
 #include "Rendering/Sprite/TileSprite.h"
 #include "Core/Scene/Entity.h"
 #include "Core/Scene/Components.h"
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 
+// Maximum tilesets a tilemap can reference in GPULayers mode,
+// must match MAX_TILESETS in res/shaders/tilemap.frag
+#define TILEMAP_MAX_TILESETS    4
+
+// Chunks mode: chunk edge length in tiles, extra ring of chunks kept
+// around the camera and chunk meshes uploaded per frame at most
+#define TILEMAP_CHUNK_SIZE              32
+#define TILEMAP_CHUNK_MARGIN            1
+#define TILEMAP_CHUNK_UPLOADS_PER_FRAME 8
+
+// Chunks mode: unused vertex buffer names kept at hand, since new
+// ones can only be created on the GL thread
+#define TILEMAP_CHUNK_BUFFER_RESERVE    64
+
 struct TilemapInput
 {
     glm::ivec2 Dimensions = { 1, 1 };
-    std::shared_ptr<Texture> Texture;
+
+    // Tileset image, usually a region of an atlas page
+    TextureRegion Region;
+};
+
+enum ETilemapRenderMode
+{
+    // Every non-empty cell becomes a scene entity with a sprite
+    Entities,
+
+    // Each layer is a texture of GIDs drawn with a single quad
+    GPULayers,
+
+    // Layers are baked into static chunk meshes around the camera,
+    // built on a worker thread as they come into view
+    Chunks
+};
+
+struct TilemapStats
+{
+    int ResidentChunks = 0;
+    int PendingChunks = 0;
+    int DrawnChunks = 0;
+    int UploadedChunks = 0;
 };
 
 class Tilemap
@@ -22,10 +67,23 @@ public:
         const std::shared_ptr<Scene>& scene,
         const char* path,
         const std::vector<TilemapInput>& tilemaps,
-        int pixelsPerUnit = 8
+        int pixelsPerUnit = 8,
+        ETilemapRenderMode renderMode = ETilemapRenderMode::Entities
+    );
+    ~Tilemap();
+
+    void Draw(
+        std::shared_ptr<Camera>& camera,
+        CommandList& commands
     );
 
-    void Draw(std::shared_ptr<Camera>& camera);
+    // Replaces a cell's GID (including Tiled flip flags). The GPU
+    // copy is updated by the next Draw(), on any thread.
+    void SetTile(int layer, int x, int y, uint32_t gid);
+    uint32_t GetTile(int layer, int x, int y) const;
+
+    [[nodiscard]]
+    const TilemapStats& GetStats() const;
 
 private:
     struct Tile
@@ -42,6 +100,21 @@ private:
         int Width = 0;
         int Height = 0;
         std::vector<Entity> TileEntities;
+
+        // Raw GIDs with flip flags, row-major
+        std::vector<uint32_t> Data;
+
+        // GPULayers mode only
+        unsigned int DataTexture = 0;
+    };
+
+    // GPULayers mode: a cell changed since the last Draw()
+    struct TileUpdate
+    {
+        int Layer = 0;
+        int X = 0;
+        int Y = 0;
+        uint32_t GID = 0;
     };
 
     struct Tileset
@@ -49,15 +122,112 @@ private:
         int FirstGID = 0;
         int Length = 0;
         TilemapInput TilemapData;
+
+        // Region of the page the tileset occupies (u0, v0, u1, v1)
+        glm::vec4 UVRect = { 0.0F, 0.0F, 1.0F, 1.0F };
+    };
+
+    struct ChunkVertex
+    {
+        glm::vec2 Position;
+        glm::vec2 UV;
+    };
+
+    // Chunk geometry for a single tileset
+    struct ChunkMesh
+    {
+        int Tileset = 0;
+        unsigned int VBO = 0;
+        int VertexCount = 0;
     };
 
+    struct Chunk
+    {
+        std::vector<ChunkMesh> Meshes;
+    };
+
+    // Work item handed to the build thread. Carries its own copy of
+    // the chunk's GIDs so the worker never touches the live layers.
+    struct ChunkJob
+    {
+        uint64_t Key = 0;
+        glm::ivec2 Origin = { 0, 0 };
+        glm::ivec2 Size = { 0, 0 };
+        std::vector<uint32_t> GIDs;
+    };
+
+    struct ChunkResult
+    {
+        uint64_t Key = 0;
+
+        // One vertex list per tileset (empty if unused)
+        std::vector<std::vector<ChunkVertex>> Vertices;
+    };
+
+    static uint64_t MakeChunkKey(int layer, int x, int y);
+
+    void CreateTileEntities(TileLayer& layer, int layerID);
+    void CreateLayerTexture(TileLayer& layer);
+    void SetupLayerRendering();
+    void SetupChunkRendering();
+
+    void DrawLayers(CommandList& commands);
+    void DrawChunks(const glm::vec4& bounds, CommandList& commands);
+
+    void RequestChunk(int layer, int x, int y);
+    void UploadChunk(ChunkResult& result, CommandList& commands);
+    void ReleaseChunk(Chunk& chunk);
+    void ReserveBuffers(CommandList& commands);
+
+    void BuildThreadLoop();
+    ChunkResult BuildChunk(const ChunkJob& job) const;
+
     std::vector<Tileset> m_tileSets;
     std::vector<TileLayer> m_tileLayers;
-    
+
     std::weak_ptr<Scene> m_scene;
 
     int m_pixelsPerUnit;
     int m_tileSize;
 
     float m_tileFootprint;
+
+    ETilemapRenderMode m_renderMode;
+
+    // GPULayers mode only
+    std::shared_ptr<Shader> m_layerShader;
+    unsigned int m_quadVAO = 0;
+    unsigned int m_quadVBO = 0;
+
+    Uniform<int> m_layerDataUniform;
+    Uniform<glm::vec2> m_layerSizeUniform;
+    Uniform<glm::vec2> m_layerWorldSizeUniform;
+
+    std::vector<TileUpdate> m_tileUpdates;
+
+    // Chunks mode only, all of it owned by the recording thread.
+    // The GL thread only replays the recorded uploads and draws.
+    std::shared_ptr<Shader> m_chunkShader;
+    unsigned int m_chunkVAO = 0;
+
+    std::unordered_map<uint64_t, Chunk> m_chunks;
+    std::unordered_set<uint64_t> m_pendingChunks;
+    std::unordered_set<uint64_t> m_dirtyChunks;
+
+    // Buffer names not used by a chunk, reused for new ones
+    std::vector<unsigned int> m_freeBuffers;
+
+    // Names created on the GL thread, not picked up yet
+    std::mutex m_bufferMutex;
+    std::vector<unsigned int> m_generatedBuffers;
+    bool m_generatingBuffers = false;
+
+    std::thread m_buildThread;
+    std::mutex m_buildMutex;
+    std::condition_variable m_buildCondition;
+    std::deque<ChunkJob> m_buildJobs;
+    std::vector<ChunkResult> m_buildResults;
+    bool m_stopBuilding = false;
+
+    TilemapStats m_stats;
 };
@@ -23,19 +23,72 @@ void Camera::SetFrustumSize(int width, int height)
     RecalculateProjMatrix();
 }
 
+void Camera::SetPosition(const glm::vec2& position)
+{
+    m_position = position;
+
+    RecalculateProjMatrix();
+}
+
+glm::vec2 Camera::GetPosition()
+{
+    return m_position;
+}
+
+void Camera::SetZoom(float zoom)
+{
+    m_zoom = glm::max(zoom, 0.01F);
+
+    RecalculateProjMatrix();
+}
+
+float Camera::GetZoom()
+{
+    return m_zoom;
+}
+
 glm::mat4 Camera::GetProjection()
 {
     return m_projMatrix;
 }
 
+glm::mat4 Camera::GetView()
+{
+    return m_viewMatrix;
+}
+
+glm::vec2 Camera::GetViewportSize()
+{
+    return { (float)m_width, (float)m_height };
+}
+
+glm::vec4 Camera::GetWorldBounds()
+{
+    return {
+        m_position.x,
+        m_position.y,
+        m_position.x + (float)m_width / m_zoom,
+        m_position.y + (float)m_height / m_zoom
+    };
+}
+
 void Camera::RecalculateProjMatrix()
 {
     m_projMatrix = glm::ortho(
-        0.0F + m_position.x,
-        (float)m_width + m_position.x,
-        (float)m_height + m_position.y,
-        0.0F + m_position.y,
+        0.0F,
+        (float)m_width,
+        (float)m_height,
+        0.0F,
         -1.0F,
         1.0F
     );
+
+    m_viewMatrix = glm::scale(
+        glm::mat4(1.0F),
+        glm::vec3(m_zoom, m_zoom, 1.0F)
+    );
+    m_viewMatrix = glm::translate(
+        m_viewMatrix,
+        glm::vec3(-m_position, 0.0F)
+    );
 }
@@ -10,13 +10,29 @@ public:
     ~Camera() = default;
 
     void SetFrustumSize(int width, int height);
+
+    // Top-left corner of the view in world units
+    void SetPosition(const glm::vec2& position);
+    glm::vec2 GetPosition();
+
+    // Screen pixels per world unit
+    void SetZoom(float zoom);
+    float GetZoom();
+
     glm::mat4 GetProjection();
+    glm::mat4 GetView();
+    glm::vec2 GetViewportSize();
+
+    // Visible world rectangle as (min x, min y, max x, max y)
+    glm::vec4 GetWorldBounds();
 
 private:
     glm::vec2 m_position = glm::vec2(0.0F);
+    float m_zoom = 1.0F;
     int m_width = 0;
     int m_height = 0;
 
     void RecalculateProjMatrix();
     glm::mat4 m_projMatrix = glm::mat4(1.0F);
+    glm::mat4 m_viewMatrix = glm::mat4(1.0F);
 };
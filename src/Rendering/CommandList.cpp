@@ -0,0 +1,558 @@
+#include "CommandList.h"
+#include "Rendering/GLState.h"
+#include "Rendering/Debug/GLTrace.h"
+#include "Rendering/StreamBuffer.h"
+
+#include <cstring>
+
+void CommandList::Clear(GLbitfield mask, const glm::vec4& color)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::Clear;
+    command.ClearArgs.Mask = mask;
+    command.ClearArgs.Color[0] = color.r;
+    command.ClearArgs.Color[1] = color.g;
+    command.ClearArgs.Color[2] = color.b;
+    command.ClearArgs.Color[3] = color.a;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::Viewport(int x, int y, int width, int height)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::Viewport;
+    command.ViewportArgs = { x, y, width, height };
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::UseProgram(unsigned int program)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::UseProgram;
+    command.BindArgs.Name = program;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BindTexture(unsigned int unit, unsigned int texture)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BindTexture;
+    command.BindArgs.Name = texture;
+    command.BindArgs.Unit = unit;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BindVertexArray(unsigned int vao)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BindVertexArray;
+    command.BindArgs.Name = vao;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BindVertexBuffer(
+    unsigned int binding,
+    unsigned int buffer,
+    size_t offset,
+    size_t stride)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BindVertexBuffer;
+    command.VertexBufferArgs.Binding = binding;
+    command.VertexBufferArgs.Buffer = buffer;
+    command.VertexBufferArgs.Offset = (uint32_t)offset;
+    command.VertexBufferArgs.Stride = (uint32_t)stride;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BindStreamVertexBuffer(unsigned int binding, size_t stride)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BindStreamVertexBuffer;
+    command.VertexBufferArgs.Binding = binding;
+    command.VertexBufferArgs.Stride = (uint32_t)stride;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BindFramebuffer(unsigned int framebuffer)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BindFramebuffer;
+    command.BindArgs.Name = framebuffer;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BlitFramebuffer(
+    unsigned int source,
+    const glm::ivec2& sourceSize,
+    const glm::ivec4& destination)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BlitFramebuffer;
+    command.BlitArgs.Source = source;
+    command.BlitArgs.SourceWidth = sourceSize.x;
+    command.BlitArgs.SourceHeight = sourceSize.y;
+    command.BlitArgs.X = destination.x;
+    command.BlitArgs.Y = destination.y;
+    command.BlitArgs.Width = destination.z;
+    command.BlitArgs.Height = destination.w;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::SetUniform(Uniform<int> uniform, int value)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::SetUniformInt;
+    command.UniformIntArgs.Location = uniform.Location;
+    command.UniformIntArgs.Count = 1;
+    command.UniformIntArgs.Values[0] = value;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::SetUniform(Uniform<float> uniform, float value)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::SetUniformFloat;
+    command.UniformFloatArgs.Location = uniform.Location;
+    command.UniformFloatArgs.Count = 1;
+    command.UniformFloatArgs.Values[0] = value;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::SetUniform(
+    Uniform<glm::vec2> uniform,
+    const glm::vec2& value)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::SetUniformFloat;
+    command.UniformFloatArgs.Location = uniform.Location;
+    command.UniformFloatArgs.Count = 2;
+    command.UniformFloatArgs.Values[0] = value.x;
+    command.UniformFloatArgs.Values[1] = value.y;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::SetUniform(
+    Uniform<glm::vec3> uniform,
+    const glm::vec3& value)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::SetUniformFloat;
+    command.UniformFloatArgs.Location = uniform.Location;
+    command.UniformFloatArgs.Count = 3;
+    command.UniformFloatArgs.Values[0] = value.x;
+    command.UniformFloatArgs.Values[1] = value.y;
+    command.UniformFloatArgs.Values[2] = value.z;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::SetUniform(
+    Uniform<glm::vec4> uniform,
+    const glm::vec4& value)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::SetUniformFloat;
+    command.UniformFloatArgs.Location = uniform.Location;
+    command.UniformFloatArgs.Count = 4;
+    command.UniformFloatArgs.Values[0] = value.x;
+    command.UniformFloatArgs.Values[1] = value.y;
+    command.UniformFloatArgs.Values[2] = value.z;
+    command.UniformFloatArgs.Values[3] = value.w;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::UpdateBuffer(
+    GLenum target,
+    unsigned int buffer,
+    size_t offset,
+    const void* data,
+    size_t size)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::UpdateBuffer;
+    command.DataArgs.Target = target;
+    command.DataArgs.Buffer = buffer;
+    command.DataArgs.Offset = (uint32_t)offset;
+    command.DataArgs.DataOffset = PushData(data, size);
+    command.DataArgs.Size = (uint32_t)size;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BufferData(
+    GLenum target,
+    unsigned int buffer,
+    const void* data,
+    size_t size,
+    GLenum usage)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BufferData;
+    command.DataArgs.Target = target;
+    command.DataArgs.Buffer = buffer;
+    command.DataArgs.DataOffset = PushData(data, size);
+    command.DataArgs.Size = (uint32_t)size;
+    command.DataArgs.Usage = usage;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::UpdateTexture(
+    unsigned int texture,
+    const glm::ivec4& rect,
+    GLenum format,
+    GLenum type,
+    const void* data,
+    size_t size)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::UpdateTexture;
+    command.TextureArgs.Texture = texture;
+    command.TextureArgs.X = rect.x;
+    command.TextureArgs.Y = rect.y;
+    command.TextureArgs.Width = rect.z;
+    command.TextureArgs.Height = rect.w;
+    command.TextureArgs.Format = format;
+    command.TextureArgs.Type = type;
+    command.TextureArgs.DataOffset = PushData(data, size);
+
+    m_commands.emplace_back(command);
+}
+
+void* CommandList::StreamData(size_t size, size_t alignment)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::StreamData;
+    command.DataArgs.DataOffset = PushData(nullptr, size);
+    command.DataArgs.Size = (uint32_t)size;
+    command.DataArgs.Alignment = (uint32_t)alignment;
+
+    m_commands.emplace_back(command);
+
+    return m_data.data() + command.DataArgs.DataOffset;
+}
+
+void CommandList::DrawArrays(GLenum mode, int first, int count)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::DrawArrays;
+    command.DrawArgs.Mode = mode;
+    command.DrawArgs.First = first;
+    command.DrawArgs.Count = count;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::DrawArraysInstanced(
+    GLenum mode,
+    int first,
+    int count,
+    int instanceCount,
+    unsigned int baseInstance)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::DrawArraysInstanced;
+    command.DrawArgs.Mode = mode;
+    command.DrawArgs.First = first;
+    command.DrawArgs.Count = count;
+    command.DrawArgs.InstanceCount = instanceCount;
+    command.DrawArgs.BaseInstance = baseInstance;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::Execute(std::function<void()> callback)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::Execute;
+    command.ExecuteArgs.Index = (uint32_t)m_callbacks.size();
+
+    m_callbacks.emplace_back(std::move(callback));
+    m_commands.emplace_back(command);
+}
+
+void CommandList::BeginPass(EProfilePass pass)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::BeginPass;
+    command.PassArgs.Pass = pass;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::EndPass(EProfilePass pass)
+{
+    RenderCommand command = {};
+    command.Type = RenderCommand::EndPass;
+    command.PassArgs.Pass = pass;
+
+    m_commands.emplace_back(command);
+}
+
+void CommandList::Replay()
+{
+    m_streamOffset = 0;
+    m_streamValid = false;
+    m_skipDraws = false;
+
+    for (const RenderCommand& command : m_commands)
+    {
+        switch (command.Type)
+        {
+            case RenderCommand::Clear:
+            {
+                const auto& args = command.ClearArgs;
+
+                glClearColor(
+                    args.Color[0],
+                    args.Color[1],
+                    args.Color[2],
+                    args.Color[3]
+                );
+                glClear(args.Mask);
+                break;
+            }
+            case RenderCommand::Viewport:
+            {
+                const auto& args = command.ViewportArgs;
+                glViewport(args.X, args.Y, args.Width, args.Height);
+                break;
+            }
+            case RenderCommand::UseProgram:
+                GLState::UseProgram(command.BindArgs.Name);
+                break;
+            case RenderCommand::BindTexture:
+                GLState::BindTexture(
+                    command.BindArgs.Unit,
+                    command.BindArgs.Name
+                );
+                break;
+            case RenderCommand::BindVertexArray:
+                GLState::BindVertexArray(command.BindArgs.Name);
+                m_skipDraws = false;
+                break;
+            case RenderCommand::BindVertexBuffer:
+            {
+                const auto& args = command.VertexBufferArgs;
+
+                GLState::BindVertexBuffer(
+                    args.Binding,
+                    args.Buffer,
+                    args.Offset,
+                    (GLsizei)args.Stride
+                );
+                break;
+            }
+            case RenderCommand::BindStreamVertexBuffer:
+            {
+                const auto& args = command.VertexBufferArgs;
+
+                // The data did not fit this frame, draws reading
+                // it are dropped until another VAO is bound
+                if (!m_streamValid)
+                {
+                    m_skipDraws = true;
+                    break;
+                }
+
+                GLState::BindVertexBuffer(
+                    args.Binding,
+                    StreamBuffer::GetID(),
+                    (GLintptr)m_streamOffset,
+                    (GLsizei)args.Stride
+                );
+                break;
+            }
+            case RenderCommand::BindFramebuffer:
+                GLState::BindFramebuffer(
+                    GL_FRAMEBUFFER,
+                    command.BindArgs.Name
+                );
+                break;
+            case RenderCommand::BlitFramebuffer:
+            {
+                const auto& args = command.BlitArgs;
+
+                GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, args.Source);
+                glBlitFramebuffer(
+                    0,
+                    0,
+                    args.SourceWidth,
+                    args.SourceHeight,
+                    args.X,
+                    args.Y,
+                    args.X + args.Width,
+                    args.Y + args.Height,
+                    GL_COLOR_BUFFER_BIT,
+                    GL_NEAREST
+                );
+                break;
+            }
+            case RenderCommand::SetUniformInt:
+            {
+                const auto& args = command.UniformIntArgs;
+                GLState::Uniform(args.Location, args.Values[0]);
+                break;
+            }
+            case RenderCommand::SetUniformFloat:
+            {
+                const auto& args = command.UniformFloatArgs;
+                GLState::Uniform(args.Location, args.Values, args.Count);
+                break;
+            }
+            case RenderCommand::UpdateBuffer:
+            {
+                const auto& args = command.DataArgs;
+
+                GLState::BindBuffer(args.Target, args.Buffer);
+                glBufferSubData(
+                    args.Target,
+                    args.Offset,
+                    args.Size,
+                    m_data.data() + args.DataOffset
+                );
+                break;
+            }
+            case RenderCommand::BufferData:
+            {
+                const auto& args = command.DataArgs;
+
+                GLState::BindBuffer(args.Target, args.Buffer);
+                glBufferData(
+                    args.Target,
+                    args.Size,
+                    m_data.data() + args.DataOffset,
+                    args.Usage
+                );
+                break;
+            }
+            case RenderCommand::UpdateTexture:
+            {
+                const auto& args = command.TextureArgs;
+
+                GLState::BindTexture(0, args.Texture);
+                glTexSubImage2D(
+                    GL_TEXTURE_2D,
+                    0,
+                    args.X,
+                    args.Y,
+                    args.Width,
+                    args.Height,
+                    args.Format,
+                    args.Type,
+                    m_data.data() + args.DataOffset
+                );
+                break;
+            }
+            case RenderCommand::StreamData:
+            {
+                const auto& args = command.DataArgs;
+
+                StreamAllocation allocation = StreamBuffer::Allocate(
+                    args.Size,
+                    args.Alignment
+                );
+
+                m_streamValid = allocation.Data != nullptr;
+                m_streamOffset = allocation.Offset;
+
+                if (m_streamValid)
+                {
+                    std::memcpy(
+                        allocation.Data,
+                        m_data.data() + args.DataOffset,
+                        args.Size
+                    );
+
+                    GLTrace::RecordUpload(args.Size);
+                }
+                break;
+            }
+            case RenderCommand::DrawArrays:
+            {
+                const auto& args = command.DrawArgs;
+
+                if (!m_skipDraws)
+                {
+                    glDrawArrays(args.Mode, args.First, args.Count);
+                }
+                break;
+            }
+            case RenderCommand::DrawArraysInstanced:
+            {
+                const auto& args = command.DrawArgs;
+
+                if (!m_skipDraws)
+                {
+                    glDrawArraysInstancedBaseInstance(
+                        args.Mode,
+                        args.First,
+                        args.Count,
+                        args.InstanceCount,
+                        args.BaseInstance
+                    );
+                }
+                break;
+            }
+            case RenderCommand::Execute:
+                m_callbacks[command.ExecuteArgs.Index]();
+
+                // Callbacks may call GL directly
+                GLState::Invalidate();
+                break;
+            case RenderCommand::BeginPass:
+                Profiler::BeginGPUPass(command.PassArgs.Pass);
+                break;
+            case RenderCommand::EndPass:
+                Profiler::EndGPUPass(command.PassArgs.Pass);
+                break;
+        }
+    }
+}
+
+void CommandList::Reset()
+{
+    // Keeps capacity, lists are refilled every frame
+    m_commands.clear();
+    m_data.clear();
+    m_callbacks.clear();
+}
+
+size_t CommandList::GetCommandCount() const
+{
+    return m_commands.size();
+}
+
+size_t CommandList::GetDataSize() const
+{
+    return m_data.size();
+}
+
+uint32_t CommandList::PushData(const void* data, size_t size)
+{
+    // Keep payloads 16 byte aligned for in-place writes
+    size_t offset = (m_data.size() + 15) & ~(size_t)15;
+
+    m_data.resize(offset + size);
+
+    if (data)
+    {
+        std::memcpy(m_data.data() + offset, data, size);
+    }
+
+    return (uint32_t)offset;
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Rendering/Shader.h"
+#include "Core/Profiler.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// One recorded GL operation. Plain data, so recording is a
+// vector append and replaying is a switch.
+struct RenderCommand
+{
+    enum EType : uint8_t
+    {
+        Clear,
+        Viewport,
+        UseProgram,
+        BindTexture,
+        BindVertexArray,
+        BindVertexBuffer,
+        BindStreamVertexBuffer,
+        BindFramebuffer,
+        BlitFramebuffer,
+        SetUniformInt,
+        SetUniformFloat,
+        UpdateBuffer,
+        BufferData,
+        UpdateTexture,
+        StreamData,
+        DrawArrays,
+        DrawArraysInstanced,
+        Execute,
+        BeginPass,
+        EndPass
+    };
+
+    EType Type;
+
+    union
+    {
+        struct
+        {
+            GLbitfield Mask;
+            float Color[4];
+        } ClearArgs;
+
+        struct
+        {
+            int X, Y, Width, Height;
+        } ViewportArgs;
+
+        struct
+        {
+            // Program, VAO, texture or framebuffer name
+            unsigned int Name;
+
+            // Texture unit
+            unsigned int Unit;
+        } BindArgs;
+
+        struct
+        {
+            unsigned int Binding;
+            unsigned int Buffer;
+            uint32_t Offset;
+            uint32_t Stride;
+        } VertexBufferArgs;
+
+        struct
+        {
+            unsigned int Source;
+            int SourceWidth, SourceHeight;
+            int X, Y, Width, Height;
+        } BlitArgs;
+
+        struct
+        {
+            int Location;
+            int Count;
+            int Values[4];
+        } UniformIntArgs;
+
+        struct
+        {
+            int Location;
+            int Count;
+            float Values[4];
+        } UniformFloatArgs;
+
+        struct
+        {
+            GLenum Target;
+            unsigned int Buffer;
+            uint32_t Offset;
+
+            // Payload in the list's data arena
+            uint32_t DataOffset;
+            uint32_t Size;
+            uint32_t Alignment;
+
+            // BufferData only
+            GLenum Usage;
+        } DataArgs;
+
+        struct
+        {
+            unsigned int Texture;
+            int X, Y, Width, Height;
+            GLenum Format;
+            GLenum Type;
+            uint32_t DataOffset;
+        } TextureArgs;
+
+        struct
+        {
+            GLenum Mode;
+            int First;
+            int Count;
+            int InstanceCount;
+            unsigned int BaseInstance;
+        } DrawArgs;
+
+        struct
+        {
+            uint32_t Index;
+        } ExecuteArgs;
+
+        struct
+        {
+            EProfilePass Pass;
+        } PassArgs;
+    };
+};
+
+// Records GL work on any thread for a single later Replay() on the
+// thread that owns the context. Buffer contents are copied into the
+// list's own arena, so recorded data may be discarded right away.
+class CommandList
+{
+public:
+    void Clear(GLbitfield mask, const glm::vec4& color);
+    void Viewport(int x, int y, int width, int height);
+
+    void UseProgram(unsigned int program);
+    void BindTexture(unsigned int unit, unsigned int texture);
+    void BindVertexArray(unsigned int vao);
+    void BindVertexBuffer(
+        unsigned int binding,
+        unsigned int buffer,
+        size_t offset,
+        size_t stride
+    );
+
+    // Binds the data of the last StreamData() command
+    void BindStreamVertexBuffer(unsigned int binding, size_t stride);
+
+    // Draw and read framebuffer, 0 for the window
+    void BindFramebuffer(unsigned int framebuffer);
+
+    // Nearest-filtered copy of all of `source` into a rectangle of
+    // the bound draw framebuffer, which must not be multisampled
+    void BlitFramebuffer(
+        unsigned int source,
+        const glm::ivec2& sourceSize,
+        const glm::ivec4& destination
+    );
+
+    // Applied to the program bound by the last UseProgram()
+    void SetUniform(Uniform<int> uniform, int value);
+    void SetUniform(Uniform<float> uniform, float value);
+    void SetUniform(Uniform<glm::vec2> uniform, const glm::vec2& value);
+    void SetUniform(Uniform<glm::vec3> uniform, const glm::vec3& value);
+    void SetUniform(Uniform<glm::vec4> uniform, const glm::vec4& value);
+
+    // glBufferSubData from a copy of `data`
+    void UpdateBuffer(
+        GLenum target,
+        unsigned int buffer,
+        size_t offset,
+        const void* data,
+        size_t size
+    );
+
+    // glBufferData from a copy of `data`, replacing the storage
+    void BufferData(
+        GLenum target,
+        unsigned int buffer,
+        const void* data,
+        size_t size,
+        GLenum usage
+    );
+
+    // glTexSubImage2D of a rectangle (x, y, width, height) of level 0
+    // from a copy of `data`, rows packed to GL's default 4 bytes
+    void UpdateTexture(
+        unsigned int texture,
+        const glm::ivec4& rect,
+        GLenum format,
+        GLenum type,
+        const void* data,
+        size_t size
+    );
+
+    // Reserves `size` bytes to be copied into the StreamBuffer on
+    // replay. The returned memory stays valid until the next
+    // command that records data.
+    void* StreamData(size_t size, size_t alignment);
+
+    void DrawArrays(GLenum mode, int first, int count);
+    void DrawArraysInstanced(
+        GLenum mode,
+        int first,
+        int count,
+        int instanceCount,
+        unsigned int baseInstance
+    );
+
+    // Escape hatch for code not expressed as commands, runs on
+    // the replaying thread in command order
+    void Execute(std::function<void()> callback);
+
+    // GPU timing, debug group and GLTrace scope of a frame pass,
+    // usually recorded through ProfileScope
+    void BeginPass(EProfilePass pass);
+    void EndPass(EProfilePass pass);
+
+    void Replay();
+    void Reset();
+
+    [[nodiscard]]
+    size_t GetCommandCount() const;
+    [[nodiscard]]
+    size_t GetDataSize() const;
+
+private:
+    uint32_t PushData(const void* data, size_t size);
+
+    std::vector<RenderCommand> m_commands;
+    std::vector<unsigned char> m_data;
+    std::vector<std::function<void()>> m_callbacks;
+
+    // Replay state: offset of the last StreamData() upload, and
+    // whether it fit into the StreamBuffer
+    size_t m_streamOffset = 0;
+    bool m_streamValid = false;
+    bool m_skipDraws = false;
+};
@@ -1,67 +1,226 @@
 #include "DebugShapes.h"
+#include "Core/Scene/Components.h"
 #include "IO/ResourceManager.h"
+#include "Rendering/GLState.h"
 
-#include <array>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+std::vector<DebugShapes::DebugVertex> DebugShapes::m_vertices;
+unsigned int DebugShapes::m_VAO = 0;
+DebugShapeStats DebugShapes::m_stats;
 
 void DebugShapes::DrawLine(
-    const std::vector<glm::vec2> &vertices,
-    const std::shared_ptr<Camera> &camera)
+    glm::vec2 from,
+    glm::vec2 to,
+    glm::vec4 color)
 {
-    // Load shader from ResourceManager
-    if (!ResourceManager::HasShader("Debug"))
+    AddLine(from, to, PackColor(color));
+}
+
+void DebugShapes::DrawLineStrip(
+    const std::vector<glm::vec2>& points,
+    glm::vec4 color)
+{
+    uint32_t packedColor = PackColor(color);
+
+    for (size_t i = 1; i < points.size(); i++)
     {
-        ResourceManager::LoadShader(
-            "res/shaders/debug/solid_color.vert",
-            "res/shaders/debug/solid_color.frag",
-            "Debug"
+        AddLine(points[i - 1], points[i], packedColor);
+    }
+}
+
+void DebugShapes::DrawBox(
+    glm::vec2 center,
+    glm::vec2 size,
+    glm::vec4 color)
+{
+    uint32_t packedColor = PackColor(color);
+
+    glm::vec2 min = center - size * 0.5F;
+    glm::vec2 max = center + size * 0.5F;
+
+    AddLine({ min.x, min.y }, { min.x, max.y }, packedColor);
+    AddLine({ min.x, max.y }, { max.x, max.y }, packedColor);
+    AddLine({ max.x, max.y }, { max.x, min.y }, packedColor);
+    AddLine({ max.x, min.y }, { min.x, min.y }, packedColor);
+}
+
+void DebugShapes::DrawCircle(
+    glm::vec2 center,
+    float radius,
+    glm::vec4 color,
+    int segments)
+{
+    uint32_t packedColor = PackColor(color);
+
+    // Rotate a single offset instead of evaluating
+    // sin/cos for every point
+    float step = glm::two_pi<float>() / (float)segments;
+    float c = std::cos(step);
+    float s = std::sin(step);
+
+    glm::vec2 offset = glm::vec2(radius, 0.0F);
+
+    for (int i = 0; i < segments; i++)
+    {
+        glm::vec2 next = glm::vec2(
+            offset.x * c - offset.y * s,
+            offset.x * s + offset.y * c
         );
+
+        AddLine(center + offset, center + next, packedColor);
+
+        offset = next;
     }
+}
 
-    auto shader = ResourceManager::GetShader("Debug");
+void DebugShapes::DrawGrid(
+    glm::vec2 origin,
+    glm::vec2 cellSize,
+    glm::ivec2 cells,
+    glm::vec4 color)
+{
+    uint32_t packedColor = PackColor(color);
 
-    // Decompose input data
-    std::vector<float> vertData;
-    vertData.reserve(vertices.size());
+    glm::vec2 end = origin + cellSize * glm::vec2(cells);
+
+    for (int x = 0; x <= cells.x; x++)
+    {
+        float lineX = origin.x + cellSize.x * (float)x;
+        AddLine({ lineX, origin.y }, { lineX, end.y }, packedColor);
+    }
 
-    for (glm::vec2 vert : vertices)
+    for (int y = 0; y <= cells.y; y++)
     {
-        vertData.emplace_back(vert.x);
-        vertData.emplace_back(vert.y);
+        float lineY = origin.y + cellSize.y * (float)y;
+        AddLine({ origin.x, lineY }, { end.x, lineY }, packedColor);
     }
+}
+
+void DebugShapes::DrawColliders(
+    const entt::registry& registry,
+    glm::vec4 color)
+{
+    uint32_t packedColor = PackColor(color);
 
-    // Construct buffers
-    unsigned int VAO, VBO;
+    auto view = registry.view<
+        const TransformComponent,
+        const BoxColliderComponent
+    >();
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    for (const auto& [entity, transform, collider] : view.each())
+    {
+        if (!collider.DrawDebugCollision)
+        {
+            continue;
+        }
+
+        glm::vec2 worldOrigin = transform.Position +
+            transform.Size * transform.Pivot +
+            collider.Position;
+        glm::vec2 halfSize = transform.Size * collider.Size * 0.5F;
 
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glm::vec2 min = worldOrigin - halfSize;
+        glm::vec2 max = worldOrigin + halfSize;
+
+        AddLine({ min.x, min.y }, { min.x, max.y }, packedColor);
+        AddLine({ min.x, max.y }, { max.x, max.y }, packedColor);
+        AddLine({ max.x, max.y }, { max.x, min.y }, packedColor);
+        AddLine({ max.x, min.y }, { min.x, min.y }, packedColor);
+    }
+}
 
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        vertData.size() * sizeof(float),
-        vertData.data(),
-        GL_STATIC_DRAW
+void DebugShapes::Init()
+{
+    ResourceManager::LoadShader(
+        "res/shaders/debug/solid_color.vert",
+        "res/shaders/debug/solid_color.frag",
+        "Debug"
     );
 
-    glVertexAttribPointer(
+    glGenVertexArrays(1, &m_VAO);
+    GLState::BindVertexArray(m_VAO);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(
         0,
         2,
         GL_FLOAT,
         GL_FALSE,
-        2 * sizeof(float),
-        (void*)nullptr
+        offsetof(DebugVertex, Position)
     );
-    glEnableVertexAttribArray(0);
+    glVertexAttribBinding(0, 0);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(
+        1,
+        4,
+        GL_UNSIGNED_BYTE,
+        GL_TRUE,
+        offsetof(DebugVertex, Color)
+    );
+    glVertexAttribBinding(1, 0);
+
+    GLState::BindVertexArray(0);
+}
+
+void DebugShapes::Flush(CommandList& commands)
+{
+    m_stats = {};
+
+    if (m_vertices.empty())
+    {
+        return;
+    }
+
+    auto shader = ResourceManager::GetShader("Debug");
+
+    size_t vertexBytes = m_vertices.size() * sizeof(DebugVertex);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    void* data = commands.StreamData(vertexBytes, sizeof(DebugVertex));
+    std::memcpy(data, m_vertices.data(), vertexBytes);
 
-    // Drawing
-    shader->Use();
-    shader->SetMat4("projection", camera->GetProjection());
-    shader->SetVec3("color", glm::vec3(0.0F, 1.0F, 0.0F));
+    commands.UseProgram(shader->ID);
+    commands.BindVertexArray(m_VAO);
+    commands.BindStreamVertexBuffer(0, sizeof(DebugVertex));
+    commands.DrawArrays(GL_LINES, 0, (int)m_vertices.size());
+    commands.BindVertexArray(0);
 
-    glDrawArrays(GL_LINE_STRIP, 0, vertData.size() / 2);
-    glBindVertexArray(0);
+    m_stats.LineCount = (int)m_vertices.size() / 2;
+    m_stats.DrawCalls = 1;
+
+    // Keeps its capacity for the next frame
+    m_vertices.clear();
+}
+
+void DebugShapes::Destroy()
+{
+    if (m_VAO != 0)
+    {
+        GLState::DeleteVertexArray(m_VAO);
+        m_VAO = 0;
+    }
+
+    m_vertices.clear();
+    m_vertices.shrink_to_fit();
+}
+
+const DebugShapeStats& DebugShapes::GetStats()
+{
+    return m_stats;
+}
+
+void DebugShapes::AddLine(glm::vec2 from, glm::vec2 to, uint32_t color)
+{
+    m_vertices.push_back({ from, color });
+    m_vertices.push_back({ to, color });
+}
+
+uint32_t DebugShapes::PackColor(glm::vec4 color)
+{
+    return glm::packUnorm4x8(color);
 }
@@ -1,17 +1,98 @@
 #pragma once
 
 #include "Rendering/Camera.h"
+#include "Rendering/CommandList.h"
 
+#include <entt/entt.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
+#define DEBUG_SHAPE_COLOR       glm::vec4(0.0F, 1.0F, 0.0F, 1.0F)
+#define DEBUG_CIRCLE_SEGMENTS   32
+
+struct DebugShapeStats
+{
+    // Lines and draws issued by the last Flush()
+    int LineCount = 0;
+    int DrawCalls = 0;
+};
+
+// Immediate mode debug lines. Shapes are collected into a CPU
+// buffer during the frame and recorded by Flush() as a single
+// GL_LINES draw streamed through the StreamBuffer.
 class DebugShapes
 {
 public:
     static void DrawLine(
-        const std::vector<glm::vec2>& vertices,
-        const std::shared_ptr<Camera>& camera
+        glm::vec2 from,
+        glm::vec2 to,
+        glm::vec4 color = DEBUG_SHAPE_COLOR
+    );
+
+    // Connects consecutive points
+    static void DrawLineStrip(
+        const std::vector<glm::vec2>& points,
+        glm::vec4 color = DEBUG_SHAPE_COLOR
+    );
+
+    static void DrawBox(
+        glm::vec2 center,
+        glm::vec2 size,
+        glm::vec4 color = DEBUG_SHAPE_COLOR
+    );
+
+    static void DrawCircle(
+        glm::vec2 center,
+        float radius,
+        glm::vec4 color = DEBUG_SHAPE_COLOR,
+        int segments = DEBUG_CIRCLE_SEGMENTS
+    );
+
+    // `cells` cells of `cellSize` starting at `origin`
+    static void DrawGrid(
+        glm::vec2 origin,
+        glm::vec2 cellSize,
+        glm::ivec2 cells,
+        glm::vec4 color = DEBUG_SHAPE_COLOR
     );
+
+    // Outlines every BoxColliderComponent that has
+    // DrawDebugCollision set
+    static void DrawColliders(
+        const entt::registry& registry,
+        glm::vec4 color = DEBUG_SHAPE_COLOR
+    );
+
+    // Loads the shader and vertex layout, needs the GL context
+    static void Init();
+
+    // Records a draw of everything queued this frame and clears it
+    static void Flush(CommandList& commands);
+
+    static void Destroy();
+
+    static const DebugShapeStats& GetStats();
+
+private:
+    // Must match the attribute layout set up in Init()
+    struct DebugVertex
+    {
+        glm::vec2 Position;
+
+        // RGBA8
+        uint32_t Color;
+    };
+
+    static void AddLine(glm::vec2 from, glm::vec2 to, uint32_t color);
+    static uint32_t PackColor(glm::vec4 color);
+
+    static std::vector<DebugVertex> m_vertices;
+
+    // Shared by every flush, vertices come from the stream buffer
+    static unsigned int m_VAO;
+
+    static DebugShapeStats m_stats;
 };
@@ -0,0 +1,429 @@
+#include "GLTrace.h"
+#include "Core/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <type_traits>
+
+bool GLTrace::m_installed = false;
+std::atomic<bool> GLTrace::m_finished = false;
+
+EGLTraceMode GLTrace::m_mode = TraceSummary;
+std::ofstream GLTrace::m_file;
+int GLTrace::m_frame = 0;
+int GLTrace::m_frameCount = 0;
+
+EGLTraceScope GLTrace::m_scope = TraceOther;
+
+std::vector<const char*> GLTrace::m_entryPoints;
+std::vector<int> GLTrace::m_entryPointCalls;
+
+GLTraceStats GLTrace::m_current;
+GLTraceStats GLTrace::m_stats;
+
+template<typename T>
+static void AppendArgument(std::string& out, T value)
+{
+    if (!out.empty())
+    {
+        out += ", ";
+    }
+
+    if constexpr (std::is_pointer_v<T>)
+    {
+        out += std::format("{}", (const void*)value);
+    }
+    else if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
+    {
+        // GLboolean and GLubyte would print as characters
+        out += std::format("{}", (int)value);
+    }
+    else
+    {
+        out += std::format("{}", value);
+    }
+}
+
+// Whether a glad function pointer is wrapped already, by any hook
+template<auto Slot>
+static bool hookedSlot = false;
+
+// Replaces one glad function pointer with Call(), which counts
+// the call and forwards to the driver
+template<auto Slot, auto Bytes, typename R, typename... Args>
+struct GLTraceHook<Slot, Bytes, R (APIENTRYP)(Args...)>
+{
+    static inline R (APIENTRYP Original)(Args...) = nullptr;
+    static inline int EntryPoint = -1;
+
+    static R APIENTRY Call(Args... args)
+    {
+        size_t bytes = 0;
+
+        if constexpr (!std::is_null_pointer_v<decltype(Bytes)>)
+        {
+            bytes = Bytes(args...);
+        }
+
+        GLTrace::RecordCall(EntryPoint, bytes);
+
+        if (GLTrace::m_mode == TraceCalls && GLTrace::m_file.is_open())
+        {
+            std::string arguments;
+            (AppendArgument(arguments, args), ...);
+
+            GLTrace::WriteCall(EntryPoint, arguments);
+        }
+
+        return Original(args...);
+    }
+
+    static void Install(const char* name)
+    {
+        // Not exported by this context, or hooked with its byte count
+        if (!*Slot || hookedSlot<Slot>)
+        {
+            return;
+        }
+
+        hookedSlot<Slot> = true;
+
+        Original = *Slot;
+        EntryPoint = GLTrace::RegisterEntryPoint(name);
+        *Slot = &Call;
+    }
+};
+
+template<auto Slot, auto Bytes = nullptr>
+static void InstallHook(const char* name)
+{
+    GLTraceHook<
+        Slot,
+        Bytes,
+        std::remove_pointer_t<decltype(Slot)>
+    >::Install(name);
+}
+
+static size_t GetPixelSize(GLenum format, GLenum type)
+{
+    size_t components = 4;
+
+    switch (format)
+    {
+        case GL_RED:
+        case GL_RED_INTEGER:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        default:
+            break;
+    }
+
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        default:
+            return components * 4;
+    }
+}
+
+static size_t BufferDataBytes(
+    GLenum,
+    GLsizeiptr size,
+    const void* data,
+    GLenum)
+{
+    return data ? (size_t)size : 0;
+}
+
+static size_t BufferStorageBytes(
+    GLenum,
+    GLsizeiptr size,
+    const void* data,
+    GLbitfield)
+{
+    return data ? (size_t)size : 0;
+}
+
+static size_t BufferSubDataBytes(
+    GLenum,
+    GLintptr,
+    GLsizeiptr size,
+    const void*)
+{
+    return (size_t)size;
+}
+
+static size_t TexImage2DBytes(
+    GLenum,
+    GLint,
+    GLint,
+    GLsizei width,
+    GLsizei height,
+    GLint,
+    GLenum format,
+    GLenum type,
+    const void* data)
+{
+    if (!data)
+    {
+        return 0;
+    }
+
+    return (size_t)width * height * GetPixelSize(format, type);
+}
+
+static size_t TexSubImage2DBytes(
+    GLenum,
+    GLint,
+    GLint,
+    GLint,
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLenum type,
+    const void*)
+{
+    return (size_t)width * height * GetPixelSize(format, type);
+}
+
+#define GL_TRACE_HOOK(name) InstallHook<&glad_##name>(#name)
+#define GL_TRACE_UPLOAD_HOOK(name, bytes) \
+    InstallHook<&glad_##name, &bytes>(#name)
+
+void GLTrace::Install(const char* path, EGLTraceMode mode, int frameCount)
+{
+    if (m_installed)
+    {
+        return;
+    }
+
+    m_mode = mode;
+    m_frameCount = frameCount;
+    m_file.open(path, std::ios::out | std::ios::trunc);
+
+    if (!m_file.is_open())
+    {
+        Log::Warning("[GLTrace] Unable to open %s, only counting", path);
+    }
+
+    // Uploads, first so they keep their byte counts
+    GL_TRACE_UPLOAD_HOOK(glBufferData, BufferDataBytes);
+    GL_TRACE_UPLOAD_HOOK(glBufferStorage, BufferStorageBytes);
+    GL_TRACE_UPLOAD_HOOK(glBufferSubData, BufferSubDataBytes);
+    GL_TRACE_UPLOAD_HOOK(glTexImage2D, TexImage2DBytes);
+    GL_TRACE_UPLOAD_HOOK(glTexSubImage2D, TexSubImage2DBytes);
+
+    // Every other entry point glad loads, listed from its header by
+    // CMake so nothing added later goes uncounted
+#define GL_TRACE_ENTRY_POINT(name) GL_TRACE_HOOK(name);
+#include "GLTraceEntryPoints.inl"
+#undef GL_TRACE_ENTRY_POINT
+
+    m_installed = true;
+
+    if (m_file.is_open() && m_mode == TraceCalls)
+    {
+        m_file << "-- startup --\n";
+    }
+
+    Log::Info(
+        "[GLTrace] Tracing %zu GL entry points to %s",
+        m_entryPoints.size(),
+        path
+    );
+}
+
+void GLTrace::SetScope(EGLTraceScope scope)
+{
+    m_scope = scope;
+}
+
+void GLTrace::RecordUpload(size_t bytes)
+{
+    if (!m_installed)
+    {
+        return;
+    }
+
+    m_current.UploadBytes += bytes;
+    m_current.ScopeBytes[m_scope] += bytes;
+}
+
+void GLTrace::RecordExternal(const char* entryPoint, int calls, size_t bytes)
+{
+    if (!m_installed)
+    {
+        return;
+    }
+
+    int index = RegisterEntryPoint(entryPoint);
+
+    m_entryPointCalls[index] += calls;
+
+    m_current.Calls += calls;
+    m_current.UploadBytes += bytes;
+    m_current.ScopeCalls[m_scope] += calls;
+    m_current.ScopeBytes[m_scope] += bytes;
+}
+
+void GLTrace::EndFrame()
+{
+    if (!m_installed)
+    {
+        return;
+    }
+
+    if (m_file.is_open())
+    {
+        if (m_mode == TraceSummary)
+        {
+            WriteSummary();
+        }
+
+        if (m_frame >= m_frameCount)
+        {
+            m_file.close();
+            m_finished = true;
+
+            Log::Info("[GLTrace] Trace of %i frames written", m_frameCount);
+        }
+    }
+
+    m_stats = m_current;
+    m_current = {};
+    m_scope = TraceOther;
+    m_frame += 1;
+
+    std::fill(m_entryPointCalls.begin(), m_entryPointCalls.end(), 0);
+
+    if (m_file.is_open() && m_mode == TraceCalls)
+    {
+        m_file << "-- frame " << m_frame << " --\n";
+    }
+}
+
+bool GLTrace::IsInstalled()
+{
+    return m_installed;
+}
+
+bool GLTrace::IsFinished()
+{
+    return m_finished;
+}
+
+GLTraceStats GLTrace::GetStats()
+{
+    return m_stats;
+}
+
+const char* GLTrace::GetScopeName(EGLTraceScope scope)
+{
+    switch (scope)
+    {
+        case TraceTilemap:
+            return "Tilemap";
+        case TraceSprites:
+            return "Sprites";
+        case TraceFonts:
+            return "Fonts";
+        case TraceDebug:
+            return "Debug";
+        case TraceImGui:
+            return "ImGui";
+        default:
+            return "Other";
+    }
+}
+
+int GLTrace::RegisterEntryPoint(const char* name)
+{
+    for (int i = 0; i < (int)m_entryPoints.size(); i++)
+    {
+        if (std::strcmp(m_entryPoints[i], name) == 0)
+        {
+            return i;
+        }
+    }
+
+    m_entryPoints.emplace_back(name);
+    m_entryPointCalls.emplace_back(0);
+
+    return (int)m_entryPoints.size() - 1;
+}
+
+void GLTrace::RecordCall(int entryPoint, size_t bytes)
+{
+    m_entryPointCalls[entryPoint] += 1;
+
+    m_current.Calls += 1;
+    m_current.UploadBytes += bytes;
+    m_current.ScopeCalls[m_scope] += 1;
+    m_current.ScopeBytes[m_scope] += bytes;
+}
+
+void GLTrace::WriteCall(int entryPoint, const std::string& arguments)
+{
+    m_file
+        << '[' << GetScopeName(m_scope) << "] "
+        << m_entryPoints[entryPoint]
+        << '(' << arguments << ")\n";
+}
+
+void GLTrace::WriteSummary()
+{
+    if (m_frame == 0)
+    {
+        m_file << "startup:";
+    }
+    else
+    {
+        m_file << "frame " << m_frame << ':';
+    }
+
+    m_file
+        << ' ' << m_current.Calls << " calls, "
+        << m_current.UploadBytes << " bytes\n";
+
+    for (int scope = 0; scope < TraceScopeCount; scope++)
+    {
+        if (m_current.ScopeCalls[scope] == 0 &&
+            m_current.ScopeBytes[scope] == 0)
+        {
+            continue;
+        }
+
+        m_file
+            << "  " << GetScopeName((EGLTraceScope)scope) << ": "
+            << m_current.ScopeCalls[scope] << " calls, "
+            << m_current.ScopeBytes[scope] << " bytes\n";
+    }
+
+    // Registration order, so frames diff line by line
+    for (int i = 0; i < (int)m_entryPoints.size(); i++)
+    {
+        if (m_entryPointCalls[i] == 0)
+        {
+            continue;
+        }
+
+        m_file
+            << "    " << m_entryPoints[i] << ": "
+            << m_entryPointCalls[i] << '\n';
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Subsystem a GL call is made for, set by the command list
+enum EGLTraceScope : uint8_t
+{
+    TraceOther,
+    TraceTilemap,
+    TraceSprites,
+    TraceFonts,
+    TraceDebug,
+    TraceImGui,
+    TraceScopeCount
+};
+
+enum EGLTraceMode
+{
+    // Call and byte counts per frame, by scope and entry point
+    TraceSummary,
+
+    // Every call with its arguments
+    TraceCalls
+};
+
+struct GLTraceStats
+{
+    int Calls = 0;
+    size_t UploadBytes = 0;
+
+    int ScopeCalls[TraceScopeCount] = {};
+    size_t ScopeBytes[TraceScopeCount] = {};
+};
+
+template<auto Slot, auto Bytes, typename Function>
+struct GLTraceHook;
+
+// Counts GL calls by wrapping every glad function pointer, so it
+// works on any driver including Mesa llvmpipe
+// (LIBGL_ALWAYS_SOFTWARE=1) on machines without a GPU. The first
+// reported frame holds everything done during loading.
+class GLTrace
+{
+public:
+    // Call right after gladLoadGLLoader(). Writes `frameCount`
+    // frames to `path`, then keeps counting for GetStats().
+    static void Install(const char* path, EGLTraceMode mode, int frameCount);
+
+    static void SetScope(EGLTraceScope scope);
+
+    // Data written to persistently mapped buffers, no GL call
+    static void RecordUpload(size_t bytes);
+
+    // Work done through another GL loader (ImGui's backend)
+    static void RecordExternal(const char* entryPoint, int calls, size_t bytes);
+
+    static void EndFrame();
+
+    [[nodiscard]]
+    static bool IsInstalled();
+
+    // All requested frames have been written
+    [[nodiscard]]
+    static bool IsFinished();
+
+    // Counts of the last finished frame. GL thread only, others
+    // read RenderThread::GetStats().
+    [[nodiscard]]
+    static GLTraceStats GetStats();
+
+    [[nodiscard]]
+    static const char* GetScopeName(EGLTraceScope scope);
+
+private:
+    template<auto Slot, auto Bytes, typename Function>
+    friend struct GLTraceHook;
+
+    static int RegisterEntryPoint(const char* name);
+    static void RecordCall(int entryPoint, size_t bytes);
+    static void WriteCall(int entryPoint, const std::string& arguments);
+    static void WriteSummary();
+
+    static bool m_installed;
+    static std::atomic<bool> m_finished;
+
+    static EGLTraceMode m_mode;
+    static std::ofstream m_file;
+    static int m_frame;
+    static int m_frameCount;
+
+    static EGLTraceScope m_scope;
+
+    static std::vector<const char*> m_entryPoints;
+    static std::vector<int> m_entryPointCalls;
+
+    static GLTraceStats m_current;
+    static GLTraceStats m_stats;
+};
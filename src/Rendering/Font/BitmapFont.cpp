@@ -1,21 +1,36 @@
 #include "BitmapFont.h"
+#include "Rendering/GLState.h"
 
 #include <nlohmann/json.hpp>
+#include <cctype>
 #include <fstream>
 
 using json = nlohmann::json;
 
+BitmapFont::~BitmapFont()
+{
+    if (m_VAO != 0)
+    {
+        GLState::DeleteVertexArray(m_VAO);
+    }
+}
+
 void BitmapFont::LoadFont(
-    std::shared_ptr<Texture>& texture,
+    const TextureRegion& region,
     const char* jsonPath)
 {
-    // Load texture
-    m_texture = texture;
+    // Load texture, glyph rectangles are relative to the region
+    m_texture = region.Page;
+    m_textureOffset = region.Offset;
 
     // Parse JSON file
     std::ifstream file(jsonPath);
     json data = json::parse(file)["characters"];
 
+    glm::vec2 pageSize = glm::vec2(m_texture->Width, m_texture->Height);
+
+    std::array<bool, FONT_GLYPH_COUNT> defined = {};
+
     for (json::iterator it = data.begin();
          it != data.end();
          it++)
@@ -34,84 +49,65 @@ void BitmapFont::LoadFont(
         );
         character.Advance = charData[2];
 
-        m_characters.insert(
-            std::pair<char, Character>(it.key()[0], character)
-        );
-    }
+        glm::vec2 min = glm::vec2(m_textureOffset + character.Bearing);
+        glm::vec2 max = min + glm::vec2(character.Size);
 
-    // Load shader
-    m_textShader = ResourceManager::LoadShader(
-        "res/shaders/font.vert",
-        "res/shaders/font.frag",
-        "TextShader"
-    );
+        character.UVs = glm::vec4(min / pageSize, max / pageSize);
+        character.Stride = (float)character.Size.x +
+            (float)character.Advance;
 
-    // Setup buffers
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
+        auto index = (unsigned char)it.key()[0];
 
-void BitmapFont::RenderText(
-    std::string text,
-    glm::vec2 position,
-    float size,
-    glm::vec3 color,
-    std::shared_ptr<Camera>& camera)
-{
-    m_textShader->Use();
-    m_textShader->SetVec3("textColor", color);
-    m_textShader->SetMat4("projection", camera->GetProjection());
+        m_glyphs[index] = character;
+        defined[index] = true;
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    m_texture->Bind();
-    m_textShader->SetInt("text", 0);
+    // Resolve every other slot once, so lookups never branch
+    const Character* fallback = nullptr;
 
-    glBindVertexArray(m_VAO);
+    if (defined[(unsigned char)FONT_FALLBACK_GLYPH])
+    {
+        fallback = &m_glyphs[(unsigned char)FONT_FALLBACK_GLYPH];
+    }
+    else if (defined[(unsigned char)' '])
+    {
+        fallback = &m_glyphs[(unsigned char)' '];
+    }
 
-    std::string::const_iterator c;
+    Character fallbackGlyph = fallback ? *fallback : Character();
 
-    for (c = text.begin(); c != text.end(); c++)
+    for (int i = 0; i < FONT_GLYPH_COUNT; i++)
     {
-        Character ch = m_characters[*c];
-
-        float w = ch.Size.x * size;
-        float h = ch.Size.y * size;
+        if (defined[i])
+        {
+            continue;
+        }
 
-        float u1 = (float)ch.Bearing.x / (float)m_texture->Width;
-        float u2 = ((float)ch.Bearing.x + (float)ch.Size.x)
-            / (float)m_texture->Width;
-        float v1 = ((float)ch.Bearing.y + (float)ch.Size.y)
-            / (float)m_texture->Height;
-        float v2 = (float)ch.Bearing.y / (float)m_texture->Height;
+        // Fold case to whichever variant the font has
+        int upper = std::toupper(i);
+        int lower = std::tolower(i);
 
-        float vertices[6][4] =
+        if (upper != i && defined[upper])
+        {
+            m_glyphs[i] = m_glyphs[upper];
+        }
+        else if (lower != i && defined[lower])
+        {
+            m_glyphs[i] = m_glyphs[lower];
+        }
+        else
         {
-            { position.x,     position.y + h,   u1, v1 },
-            { position.x,     position.y,       u1, v2 },
-            { position.x + w, position.y,       u2, v2 },
-    
-            { position.x,     position.y + h,   u1, v1 },
-            { position.x + w, position.y,       u2, v2 },
-            { position.x + w, position.y + h,   u2, v1 }
-        };
-
-        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        position.x += ((float)ch.Size.x + (float)ch.Advance) * size;
+            m_glyphs[i] = fallbackGlyph;
+        }
     }
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Setup vertex layout, vertices are streamed per frame
+    glGenVertexArrays(1, &m_VAO);
+    GLState::BindVertexArray(m_VAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(0, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+    GLState::BindVertexArray(0);
 }
 
 void BitmapFont::BindTexture()
@@ -119,9 +115,9 @@ void BitmapFont::BindTexture()
     m_texture->Bind();
 }
 
-Character BitmapFont::GetCharacter(char character)
+const Character& BitmapFont::GetCharacter(char character) const
 {
-    return m_characters[character];
+    return m_glyphs[(unsigned char)character];
 }
 
 const std::shared_ptr<Texture>& BitmapFont::GetTexture() const
@@ -134,7 +130,47 @@ unsigned int BitmapFont::GetVAO() const
     return m_VAO;
 }
 
-unsigned int BitmapFont::GetVBO() const
+int BitmapFont::GetTextVertexCount(std::string_view text) const
 {
-    return m_VBO;
+    return (int)text.size() * 6;
+}
+
+int BitmapFont::WriteTextVertices(
+    std::string_view text,
+    glm::vec2 position,
+    float size,
+    glm::vec4* vertices)
+{
+    int vertexCount = 0;
+
+    for (char c : text)
+    {
+        const Character& ch = m_glyphs[(unsigned char)c];
+
+        float w = (float)ch.Size.x * size;
+        float h = (float)ch.Size.y * size;
+
+        const glm::vec4& uvs = ch.UVs;
+
+        float u1 = uvs.x;
+        float u2 = uvs.z;
+        float v1 = uvs.w;
+        float v2 = uvs.y;
+
+        glm::vec4* quad = vertices + vertexCount;
+
+        quad[0] = { position.x,     position.y + h,   u1, v1 };
+        quad[1] = { position.x,     position.y,       u1, v2 };
+        quad[2] = { position.x + w, position.y,       u2, v2 };
+
+        quad[3] = { position.x,     position.y + h,   u1, v1 };
+        quad[4] = { position.x + w, position.y,       u2, v2 };
+        quad[5] = { position.x + w, position.y + h,   u2, v1 };
+
+        vertexCount += 6;
+
+        position.x += ch.Stride * size;
+    }
+
+    return vertexCount;
 }
@@ -5,16 +5,33 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <map>
+#include <array>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
 
+// Glyph vertices are (x, y, u, v)
+#define FONT_VERTEX_SIZE    (4 * sizeof(float))
+
+// One table slot per byte value
+#define FONT_GLYPH_COUNT    256
+
+// Drawn for characters the font has no glyph for (if the font
+// has no such glyph either, a space is used)
+#define FONT_FALLBACK_GLYPH '?'
+
 struct Character
 {
-    unsigned int TextureId;
-    glm::ivec2 Size;
-    glm::ivec2 Bearing;
-    unsigned int Advance;
+    unsigned int TextureId = 0;
+    glm::ivec2 Size = { 0, 0 };
+    glm::ivec2 Bearing = { 0, 0 };
+    unsigned int Advance = 0;
+
+    // Precomputed at load time: normalized (u0, v0, u1, v1) within
+    // the texture page, and the pen advance (size plus spacing)
+    glm::vec4 UVs = glm::vec4(0.0F);
+    float Stride = 0.0F;
 };
 
 class BitmapFont
@@ -22,39 +39,46 @@ class BitmapFont
     friend class Renderer;
 public:
     void LoadFont(
-        std::shared_ptr<Texture>& texture,
+        const TextureRegion& region,
         const char* jsonPath
     );
 
-    void RenderText(
-        std::string text,
-        glm::vec2 position,
-        float size,
-        glm::vec3 color,
-        std::shared_ptr<Camera>& camera
-    );
-    
     void BindTexture();
 
     BitmapFont() = default;
-    ~BitmapFont() = default;
+    ~BitmapFont();
     
 protected:
-    Character GetCharacter(char character);
+    // Never fails, unknown characters give the fallback glyph
+    [[nodiscard]]
+    const Character& GetCharacter(char character) const;
     
     [[nodiscard]]
     const std::shared_ptr<Texture>& GetTexture() const;
     
+    // Source the vertices from binding 0
     [[nodiscard]]
     unsigned int GetVAO() const;
+    
     [[nodiscard]]
-    unsigned int GetVBO() const;
+    int GetTextVertexCount(std::string_view text) const;
+    
+    // Writes the glyph quads of `text` as triangles, returns
+    // the number of vertices written
+    int WriteTextVertices(
+        std::string_view text,
+        glm::vec2 position,
+        float size,
+        glm::vec4* vertices
+    );
     
 private:
-    std::map<char, Character> m_characters;
+    // Indexed by byte value, with case folding and fallbacks
+    // already resolved
+    std::array<Character, FONT_GLYPH_COUNT> m_glyphs;
 
     std::shared_ptr<Texture> m_texture;
-    std::shared_ptr<Shader> m_textShader;
+    glm::ivec2 m_textureOffset = { 0, 0 };
 
-    unsigned int m_VAO, m_VBO;
+    unsigned int m_VAO = 0;
 };
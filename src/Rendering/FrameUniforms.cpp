@@ -0,0 +1,59 @@
+#include "FrameUniforms.h"
+#include "Core/Log.h"
+#include "Rendering/GLState.h"
+
+FrameUniforms::FrameUniforms()
+{
+    glGenBuffers(1, &m_UBO);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+    glBufferData(
+        GL_UNIFORM_BUFFER,
+        sizeof(FrameData),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    );
+
+    // The binding point never changes, so bind it once. This also
+    // binds the generic target, so unbind after to keep GLState right.
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, m_UBO);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    Log::Info("[FrameUniforms] Frame uniform buffer created");
+}
+
+FrameUniforms::~FrameUniforms()
+{
+    GLState::DeleteBuffer(m_UBO);
+}
+
+void FrameUniforms::Update(
+    CommandList& commands,
+    Camera& camera,
+    float time,
+    float deltaTime)
+{
+    glm::vec2 viewportSize = camera.GetViewportSize();
+
+    FrameData data = {};
+    data.Projection = camera.GetProjection();
+    data.View = camera.GetView();
+    data.Viewport = glm::vec4(viewportSize, 1.0F / viewportSize);
+    data.Time = time;
+    data.DeltaTime = deltaTime;
+    data.FrameIndex = m_frameIndex;
+
+    commands.UpdateBuffer(
+        GL_UNIFORM_BUFFER,
+        m_UBO,
+        0,
+        &data,
+        sizeof(FrameData)
+    );
+
+    m_frameIndex += 1;
+}
+
+int FrameUniforms::GetFrameIndex() const
+{
+    return m_frameIndex;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Rendering/Camera.h"
+#include "Rendering/CommandList.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Uniform block binding point shared by every shader program
+// that includes res/shaders/common/frame_data.glsl
+#define FRAME_DATA_BLOCK_NAME   "FrameData"
+#define FRAME_DATA_BINDING      0
+
+// Owns the per-frame uniform buffer (camera matrices, viewport,
+// clock), uploaded once per frame instead of once per draw.
+class FrameUniforms
+{
+public:
+    FrameUniforms();
+    ~FrameUniforms();
+
+    void Update(
+        CommandList& commands,
+        Camera& camera,
+        float time,
+        float deltaTime
+    );
+
+    [[nodiscard]]
+    int GetFrameIndex() const;
+
+private:
+    // std140 layout, must match frame_data.glsl
+    struct FrameData
+    {
+        glm::mat4 Projection;
+        glm::mat4 View;
+        glm::vec4 Viewport;
+        float Time;
+        float DeltaTime;
+        int FrameIndex;
+        float Padding;
+    };
+
+    static_assert(
+        sizeof(FrameData) == 160,
+        "FrameData must match the std140 layout in frame_data.glsl"
+    );
+
+    unsigned int m_UBO = 0;
+    int m_frameIndex = 0;
+};
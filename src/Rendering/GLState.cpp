@@ -0,0 +1,408 @@
+#include "GLState.h"
+
+#include <cstring>
+
+// Never a valid name, forces the next bind through
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu
+
+unsigned int GLState::m_program = GL_STATE_UNKNOWN;
+unsigned int GLState::m_activeUnit = GL_STATE_UNKNOWN;
+unsigned int GLState::m_textures[GL_STATE_TEXTURE_UNITS] = {};
+unsigned int GLState::m_vertexArray = GL_STATE_UNKNOWN;
+unsigned int GLState::m_arrayBuffer = GL_STATE_UNKNOWN;
+unsigned int GLState::m_uniformBuffer = GL_STATE_UNKNOWN;
+GLState::VertexBinding GLState::m_vertexBindings[GL_STATE_VERTEX_BINDINGS] = {};
+unsigned int GLState::m_drawFramebuffer = GL_STATE_UNKNOWN;
+unsigned int GLState::m_readFramebuffer = GL_STATE_UNKNOWN;
+
+int GLState::m_blend = -1;
+GLenum GLState::m_blendSource = GL_STATE_UNKNOWN;
+GLenum GLState::m_blendDestination = GL_STATE_UNKNOWN;
+
+std::unordered_map<
+    unsigned int,
+    std::vector<GLState::UniformValue>
+> GLState::m_uniforms;
+std::vector<GLState::UniformValue>* GLState::m_programUniforms = nullptr;
+
+GLStateStats GLState::m_frame;
+GLStateStats GLState::m_stats;
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (!Changed(m_program != program))
+    {
+        return;
+    }
+
+    glUseProgram(program);
+    m_program = program;
+
+    m_programUniforms = program != 0 ? &m_uniforms[program] : nullptr;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int texture)
+{
+    if (unit >= GL_STATE_TEXTURE_UNITS)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        m_activeUnit = unit;
+        return;
+    }
+
+    if (!Changed(m_textures[unit] != texture))
+    {
+        return;
+    }
+
+    if (m_activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        m_activeUnit = unit;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    m_textures[unit] = texture;
+}
+
+void GLState::BindVertexArray(unsigned int vao)
+{
+    if (!Changed(m_vertexArray != vao))
+    {
+        return;
+    }
+
+    glBindVertexArray(vao);
+    m_vertexArray = vao;
+
+    // Vertex buffer bindings belong to the VAO
+    for (VertexBinding& binding : m_vertexBindings)
+    {
+        binding = { GL_STATE_UNKNOWN, 0, 0 };
+    }
+}
+
+void GLState::BindBuffer(GLenum target, unsigned int buffer)
+{
+    unsigned int* bound = nullptr;
+
+    // Element buffers are VAO state and go straight through
+    if (target == GL_ARRAY_BUFFER)
+    {
+        bound = &m_arrayBuffer;
+    }
+    else if (target == GL_UNIFORM_BUFFER)
+    {
+        bound = &m_uniformBuffer;
+    }
+
+    if (bound && !Changed(*bound != buffer))
+    {
+        return;
+    }
+
+    glBindBuffer(target, buffer);
+
+    if (bound)
+    {
+        *bound = buffer;
+    }
+}
+
+void GLState::BindVertexBuffer(
+    unsigned int binding,
+    unsigned int buffer,
+    GLintptr offset,
+    GLsizei stride)
+{
+    if (binding < GL_STATE_VERTEX_BINDINGS)
+    {
+        VertexBinding& bound = m_vertexBindings[binding];
+
+        bool changed =
+            bound.Buffer != buffer ||
+            bound.Offset != offset ||
+            bound.Stride != stride;
+
+        if (!Changed(changed))
+        {
+            return;
+        }
+
+        bound = { buffer, offset, stride };
+    }
+
+    glBindVertexBuffer(binding, buffer, offset, stride);
+}
+
+void GLState::BindFramebuffer(GLenum target, unsigned int framebuffer)
+{
+    bool draw = target != GL_READ_FRAMEBUFFER;
+    bool read = target != GL_DRAW_FRAMEBUFFER;
+
+    bool changed =
+        (draw && m_drawFramebuffer != framebuffer) ||
+        (read && m_readFramebuffer != framebuffer);
+
+    if (!Changed(changed))
+    {
+        return;
+    }
+
+    glBindFramebuffer(target, framebuffer);
+
+    if (draw)
+    {
+        m_drawFramebuffer = framebuffer;
+    }
+    if (read)
+    {
+        m_readFramebuffer = framebuffer;
+    }
+}
+
+void GLState::SetBlend(bool enabled)
+{
+    if (!Changed(m_blend != (int)enabled))
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(GL_BLEND);
+    }
+    else
+    {
+        glDisable(GL_BLEND);
+    }
+
+    m_blend = (int)enabled;
+}
+
+void GLState::BlendFunc(GLenum source, GLenum destination)
+{
+    bool changed =
+        m_blendSource != source ||
+        m_blendDestination != destination;
+
+    if (!Changed(changed))
+    {
+        return;
+    }
+
+    glBlendFunc(source, destination);
+
+    m_blendSource = source;
+    m_blendDestination = destination;
+}
+
+void GLState::Uniform(int location, int value)
+{
+    if (SetUniformValue(location, &value, sizeof(int)))
+    {
+        glUniform1i(location, value);
+    }
+}
+
+void GLState::Uniform(int location, const float* values, int count)
+{
+    if (!SetUniformValue(location, values, count * sizeof(float)))
+    {
+        return;
+    }
+
+    switch (count)
+    {
+        case 1:
+            glUniform1fv(location, 1, values);
+            break;
+        case 2:
+            glUniform2fv(location, 1, values);
+            break;
+        case 3:
+            glUniform3fv(location, 1, values);
+            break;
+        default:
+            glUniform4fv(location, 1, values);
+            break;
+    }
+}
+
+void GLState::UniformMatrix4(int location, const float* values)
+{
+    if (SetUniformValue(location, values, 16 * sizeof(float)))
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, values);
+    }
+}
+
+void GLState::DeleteProgram(unsigned int program)
+{
+    glDeleteProgram(program);
+
+    m_uniforms.erase(program);
+
+    if (m_program == program)
+    {
+        m_program = 0;
+        m_programUniforms = nullptr;
+    }
+}
+
+void GLState::DeleteTexture(unsigned int texture)
+{
+    glDeleteTextures(1, &texture);
+
+    // GL unbinds deleted textures from every unit
+    for (unsigned int& bound : m_textures)
+    {
+        if (bound == texture)
+        {
+            bound = 0;
+        }
+    }
+}
+
+void GLState::DeleteVertexArray(unsigned int vao)
+{
+    glDeleteVertexArrays(1, &vao);
+
+    // GL falls back to the default VAO
+    if (m_vertexArray == vao)
+    {
+        m_vertexArray = 0;
+
+        for (VertexBinding& binding : m_vertexBindings)
+        {
+            binding = { GL_STATE_UNKNOWN, 0, 0 };
+        }
+    }
+}
+
+void GLState::DeleteBuffer(unsigned int buffer)
+{
+    glDeleteBuffers(1, &buffer);
+
+    if (m_arrayBuffer == buffer)
+    {
+        m_arrayBuffer = 0;
+    }
+    if (m_uniformBuffer == buffer)
+    {
+        m_uniformBuffer = 0;
+    }
+
+    for (VertexBinding& binding : m_vertexBindings)
+    {
+        if (binding.Buffer == buffer)
+        {
+            binding.Buffer = GL_STATE_UNKNOWN;
+        }
+    }
+}
+
+void GLState::DeleteFramebuffer(unsigned int framebuffer)
+{
+    glDeleteFramebuffers(1, &framebuffer);
+
+    // GL falls back to the default framebuffer
+    if (m_drawFramebuffer == framebuffer)
+    {
+        m_drawFramebuffer = 0;
+    }
+    if (m_readFramebuffer == framebuffer)
+    {
+        m_readFramebuffer = 0;
+    }
+}
+
+void GLState::Invalidate()
+{
+    m_program = GL_STATE_UNKNOWN;
+    m_programUniforms = nullptr;
+    m_activeUnit = GL_STATE_UNKNOWN;
+    m_vertexArray = GL_STATE_UNKNOWN;
+    m_arrayBuffer = GL_STATE_UNKNOWN;
+    m_uniformBuffer = GL_STATE_UNKNOWN;
+
+    for (unsigned int& texture : m_textures)
+    {
+        texture = GL_STATE_UNKNOWN;
+    }
+
+    for (VertexBinding& binding : m_vertexBindings)
+    {
+        binding = { GL_STATE_UNKNOWN, 0, 0 };
+    }
+
+    m_drawFramebuffer = GL_STATE_UNKNOWN;
+    m_readFramebuffer = GL_STATE_UNKNOWN;
+
+    m_blend = -1;
+    m_blendSource = GL_STATE_UNKNOWN;
+    m_blendDestination = GL_STATE_UNKNOWN;
+}
+
+void GLState::EndFrame()
+{
+    m_stats = m_frame;
+    m_frame = {};
+}
+
+GLStateStats GLState::GetStats()
+{
+    return m_stats;
+}
+
+bool GLState::Changed(bool changed)
+{
+    m_frame.Calls++;
+
+    if (!changed)
+    {
+        m_frame.Redundant++;
+    }
+
+    return changed;
+}
+
+bool GLState::SetUniformValue(int location, const void* data, size_t size)
+{
+    if (location < 0)
+    {
+        return false;
+    }
+
+    // Program not seen through UseProgram(), can't shadow it
+    if (!m_programUniforms)
+    {
+        m_frame.Calls++;
+        return true;
+    }
+
+    std::vector<UniformValue>& values = *m_programUniforms;
+
+    if ((size_t)location >= values.size())
+    {
+        values.resize(location + 1);
+    }
+
+    UniformValue& value = values[location];
+
+    bool changed =
+        value.Size != size ||
+        std::memcmp(value.Data, data, size) != 0;
+
+    if (!Changed(changed))
+    {
+        return false;
+    }
+
+    value.Size = (uint32_t)size;
+    std::memcpy(value.Data, data, size);
+
+    return true;
+}
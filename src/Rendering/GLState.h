@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#define GL_STATE_TEXTURE_UNITS      16
+#define GL_STATE_VERTEX_BINDINGS    4
+
+// Largest uniform value shadowed (a mat4)
+#define GL_STATE_UNIFORM_SIZE       (16 * sizeof(float))
+
+struct GLStateStats
+{
+    // State changes requested in the last finished frame
+    int Calls = 0;
+
+    // Of those, changes skipped because the state already matched
+    int Redundant = 0;
+};
+
+// Shadow copy of the GL state the renderer touches. Binds, blend
+// state and uniforms go through here and only reach GL when they
+// change something. Must only be used on the thread that owns the
+// context; code that calls GL directly has to Invalidate() after.
+class GLState
+{
+public:
+    static void UseProgram(unsigned int program);
+    static void BindTexture(unsigned int unit, unsigned int texture);
+    static void BindVertexArray(unsigned int vao);
+    static void BindBuffer(GLenum target, unsigned int buffer);
+    static void BindVertexBuffer(
+        unsigned int binding,
+        unsigned int buffer,
+        GLintptr offset,
+        GLsizei stride
+    );
+
+    // GL_FRAMEBUFFER binds both the draw and the read framebuffer
+    static void BindFramebuffer(GLenum target, unsigned int framebuffer);
+
+    static void SetBlend(bool enabled);
+    static void BlendFunc(GLenum source, GLenum destination);
+
+    // Applied to the current program
+    static void Uniform(int location, int value);
+    static void Uniform(int location, const float* values, int count);
+    static void UniformMatrix4(int location, const float* values);
+
+    // Deleting also forgets the name, GL reuses them
+    static void DeleteProgram(unsigned int program);
+    static void DeleteTexture(unsigned int texture);
+    static void DeleteVertexArray(unsigned int vao);
+    static void DeleteBuffer(unsigned int buffer);
+    static void DeleteFramebuffer(unsigned int framebuffer);
+
+    // Forgets every binding, uniform values are kept as they
+    // belong to the programs
+    static void Invalidate();
+
+    static void EndFrame();
+
+    // GL thread only, others read RenderThread::GetStats()
+    [[nodiscard]]
+    static GLStateStats GetStats();
+
+private:
+    struct VertexBinding
+    {
+        unsigned int Buffer;
+        GLintptr Offset;
+        GLsizei Stride;
+    };
+
+    struct UniformValue
+    {
+        // 0 while the value is unknown
+        uint32_t Size = 0;
+        unsigned char Data[GL_STATE_UNIFORM_SIZE];
+    };
+
+    // True if the call has to reach GL
+    static bool Changed(bool changed);
+    static bool SetUniformValue(int location, const void* data, size_t size);
+
+    static unsigned int m_program;
+    static unsigned int m_activeUnit;
+    static unsigned int m_textures[GL_STATE_TEXTURE_UNITS];
+    static unsigned int m_vertexArray;
+    static unsigned int m_arrayBuffer;
+    static unsigned int m_uniformBuffer;
+    static VertexBinding m_vertexBindings[GL_STATE_VERTEX_BINDINGS];
+    static unsigned int m_drawFramebuffer;
+    static unsigned int m_readFramebuffer;
+
+    static int m_blend;
+    static GLenum m_blendSource;
+    static GLenum m_blendDestination;
+
+    // Uniform values per program, indexed by location
+    static std::unordered_map<
+        unsigned int,
+        std::vector<UniformValue>
+    > m_uniforms;
+    static std::vector<UniformValue>* m_programUniforms;
+
+    static GLStateStats m_frame;
+    static GLStateStats m_stats;
+};
@@ -0,0 +1,54 @@
+#include "RenderTarget.h"
+#include "Core/Log.h"
+#include "Rendering/GLState.h"
+
+RenderTarget::RenderTarget(int width, int height)
+    : m_size(width, height)
+{
+    glGenRenderbuffers(1, &m_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_FBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,
+        GL_COLOR_ATTACHMENT0,
+        GL_RENDERBUFFER,
+        m_colorBuffer
+    );
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        Log::Critical(
+            "[RenderTarget] Framebuffer of [%i, %i] is incomplete!",
+            width,
+            height
+        );
+    }
+
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    Log::Info(
+        "[RenderTarget] Render target created with dimensions [%i, %i]",
+        width,
+        height
+    );
+}
+
+RenderTarget::~RenderTarget()
+{
+    GLState::DeleteFramebuffer(m_FBO);
+    glDeleteRenderbuffers(1, &m_colorBuffer);
+}
+
+unsigned int RenderTarget::GetFramebuffer() const
+{
+    return m_FBO;
+}
+
+glm::ivec2 RenderTarget::GetSize() const
+{
+    return m_size;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Offscreen color buffer the scene is drawn into, then blitted
+// to the window. Single sampled, pixel art has no edges to smooth.
+class RenderTarget
+{
+public:
+    RenderTarget(int width, int height);
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    [[nodiscard]]
+    unsigned int GetFramebuffer() const;
+    [[nodiscard]]
+    glm::ivec2 GetSize() const;
+
+private:
+    unsigned int m_FBO = 0;
+    unsigned int m_colorBuffer = 0;
+    glm::ivec2 m_size;
+};
@@ -0,0 +1,184 @@
+#include "RenderThread.h"
+#include "Rendering/GLState.h"
+#include "Rendering/Debug/GLTrace.h"
+#include "Rendering/StreamBuffer.h"
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+
+#include <chrono>
+
+RenderThread::RenderThread(GLFWwindow* window, bool threaded)
+    : m_window(window),
+      m_threaded(threaded)
+{
+    if (!m_threaded)
+    {
+        return;
+    }
+
+    // A context can only be current on one thread
+    glfwMakeContextCurrent(nullptr);
+
+    m_thread = std::thread(&RenderThread::ThreadLoop, this);
+
+    Log::Info("[RenderThread] Rendering on a dedicated GL thread");
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+CommandList& RenderThread::BeginFrame()
+{
+    if (m_threaded)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::unique_lock lock(m_mutex);
+
+        m_condition.wait(lock, [this]
+        {
+            return !m_listBusy[m_recordIndex];
+        });
+
+        auto end = std::chrono::steady_clock::now();
+
+        m_waitMilliseconds =
+            std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    return m_lists[m_recordIndex];
+}
+
+void RenderThread::Submit()
+{
+    int index = m_recordIndex;
+    m_recordIndex = (m_recordIndex + 1) % RENDER_THREAD_LISTS;
+
+    if (!m_threaded)
+    {
+        Present(m_lists[index]);
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_listBusy[index] = true;
+        m_queue.emplace_back(index);
+    }
+
+    m_condition.notify_all();
+}
+
+void RenderThread::Stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+    m_thread.join();
+
+    glfwMakeContextCurrent(m_window);
+}
+
+bool RenderThread::IsThreaded() const
+{
+    return m_threaded;
+}
+
+RenderThreadStats RenderThread::GetStats() const
+{
+    RenderThreadStats stats = {};
+    stats.ReplayMilliseconds = m_replayMilliseconds;
+    stats.WaitMilliseconds = m_waitMilliseconds;
+    stats.CommandCount = m_commandCount;
+
+    std::lock_guard lock(m_statsMutex);
+
+    stats.Stream = m_streamStats;
+    stats.State = m_stateStats;
+    stats.Trace = m_traceStats;
+
+    return stats;
+}
+
+void RenderThread::ThreadLoop()
+{
+    glfwMakeContextCurrent(m_window);
+
+    while (true)
+    {
+        int index;
+
+        {
+            std::unique_lock lock(m_mutex);
+
+            m_condition.wait(lock, [this]
+            {
+                return m_stop || !m_queue.empty();
+            });
+
+            // Finish queued frames before stopping
+            if (m_queue.empty())
+            {
+                break;
+            }
+
+            index = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        Present(m_lists[index]);
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_listBusy[index] = false;
+        }
+
+        m_condition.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::Present(CommandList& commands)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    StreamBuffer::BeginFrame();
+    Profiler::BeginGPUFrame();
+    commands.Replay();
+    StreamBuffer::EndFrame();
+    GLState::EndFrame();
+    GLTrace::EndFrame();
+
+    // Not counting the swap, which waits for vsync
+    auto end = std::chrono::steady_clock::now();
+
+    m_replayMilliseconds =
+        std::chrono::duration<float, std::milli>(end - start).count();
+    m_commandCount = (int)commands.GetCommandCount();
+
+    {
+        std::lock_guard lock(m_statsMutex);
+
+        m_streamStats = StreamBuffer::GetStats();
+        m_stateStats = GLState::GetStats();
+        m_traceStats = GLTrace::GetStats();
+    }
+
+    // ImGui viewports may have switched contexts
+    glfwMakeContextCurrent(m_window);
+    glfwSwapBuffers(m_window);
+
+    commands.Reset();
+}
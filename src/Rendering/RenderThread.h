@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Rendering/CommandList.h"
+#include "Rendering/GLState.h"
+#include "Rendering/StreamBuffer.h"
+#include "Rendering/Debug/GLTrace.h"
+
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Frames recorded while the previous one is replayed
+#define RENDER_THREAD_LISTS 2
+
+struct RenderThreadStats
+{
+    // GL thread time spent replaying a frame (without the swap)
+    float ReplayMilliseconds = 0.0F;
+
+    // Recording thread time spent waiting for a free list
+    float WaitMilliseconds = 0.0F;
+
+    int CommandCount = 0;
+
+    // Copied on the GL thread once the frame is replayed
+    StreamBufferStats Stream;
+    GLStateStats State;
+    GLTraceStats Trace;
+};
+
+// Owns the GL context after start-up. Frames are recorded into one
+// of two command lists and replayed, streamed and presented by a
+// dedicated GL thread, so the CPU side of frame N+1 overlaps the GL
+// submission of frame N. Without threading the lists are replayed
+// on the calling thread as soon as they are submitted.
+class RenderThread
+{
+public:
+    RenderThread(GLFWwindow* window, bool threaded);
+    ~RenderThread();
+
+    // Waits until the GL thread is done with the list
+    CommandList& BeginFrame();
+
+    // Queues the list for replay and presents it
+    void Submit();
+
+    // Replays everything queued and hands the context back
+    // to the calling thread
+    void Stop();
+
+    [[nodiscard]]
+    bool IsThreaded() const;
+
+    [[nodiscard]]
+    RenderThreadStats GetStats() const;
+
+private:
+    void ThreadLoop();
+    void Present(CommandList& commands);
+
+    GLFWwindow* m_window;
+    bool m_threaded;
+
+    CommandList m_lists[RENDER_THREAD_LISTS];
+    bool m_listBusy[RENDER_THREAD_LISTS] = {};
+    int m_recordIndex = 0;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<int> m_queue;
+    bool m_stop = false;
+
+    std::atomic<float> m_replayMilliseconds = 0.0F;
+    std::atomic<float> m_waitMilliseconds = 0.0F;
+    std::atomic<int> m_commandCount = 0;
+
+    mutable std::mutex m_statsMutex;
+    StreamBufferStats m_streamStats;
+    GLStateStats m_stateStats;
+    GLTraceStats m_traceStats;
+};
@@ -1,16 +1,19 @@
 #include "Shader.h"
 #include "Core/Log.h"
+#include "Rendering/FrameUniforms.h"
+#include "Rendering/GLState.h"
+#include "Rendering/ShaderCache.h"
 
+#include <chrono>
 #include <fstream>
-#include <sstream>
-#include <iostream>
 #include <string>
 #include <cstring>
 #include <cstdlib>
+#include <format>
 
 Shader& Shader::Use()
 {
-    glUseProgram(ID);
+    GLState::UseProgram(ID);
     return *this;
 }
 
@@ -21,20 +24,24 @@ Shader& Shader::Use()
 //
 void Shader::Load(const char* vertPath, const char* fragPath)
 {
-    std::string vertSourceStr = ReadTextFile(vertPath);
-    std::string fragSourceStr = ReadTextFile(fragPath);
+    Begin(vertPath, fragPath);
+    Finish();
+}
 
-    const char* vertSource = vertSourceStr.c_str();
-    const char* fragSource = fragSourceStr.c_str();
+ShaderSource Shader::ReadSource(const char* vertPath, const char* fragPath)
+{
+    ShaderSource source = {};
+    source.Vert = ReadTextFile(vertPath);
+    source.Frag = ReadTextFile(fragPath);
 
-    if (!vertSource)
+    if (source.Vert.empty())
     {
         Log::Warning(
             "ERROR: Vertex source %s failed to load!",
             vertPath
         );
     }
-    if (!fragSource)
+    if (source.Frag.empty())
     {
         Log::Warning(
             "ERROR: Fragment source %s failed to load!",
@@ -42,94 +49,305 @@ void Shader::Load(const char* vertPath, const char* fragPath)
         );
     }
 
-    unsigned int vert, frag;
+    source.Key = ShaderCache::GetKey(source.Vert, source.Frag);
+
+    return source;
+}
+
+void Shader::Begin(const char* vertPath, const char* fragPath)
+{
+    Begin(ReadSource(vertPath, fragPath));
+}
+
+void Shader::Begin(const ShaderSource& source)
+{
+    m_compileStart = std::chrono::steady_clock::now();
+    m_compileEnd = {};
+
+    m_finished = false;
+    m_cacheKey = source.Key;
+
+    ID = glCreateProgram();
+
+    if (ShaderCache::Load(m_cacheKey, ID))
+    {
+        return;
+    }
+
+    const char* vertSource = source.Vert.c_str();
+    const char* fragSource = source.Frag.c_str();
 
     // Vertex shader
-    vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vertSource, nullptr);
-    glCompileShader(vert);
-    CheckCompilerErrors(vert, EShaderType::Vertex);
+    m_vert = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(m_vert, 1, &vertSource, nullptr);
+    glCompileShader(m_vert);
 
     // Fragment shader
-    frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fragSource, nullptr);
-    glCompileShader(frag);
-    CheckCompilerErrors(frag, EShaderType::Fragment);
+    m_frag = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(m_frag, 1, &fragSource, nullptr);
+    glCompileShader(m_frag);
 
-    // Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vert);
-    glAttachShader(ID, frag);
+    // Program, the statuses are only read in Finish()
+    ShaderCache::PrepareProgram(ID);
+    glAttachShader(ID, m_vert);
+    glAttachShader(ID, m_frag);
     glLinkProgram(ID);
-    CheckCompilerErrors(ID, EShaderType::Program);
 
-    // Cleanup
-    glDeleteShader(vert);
-    glDeleteShader(frag);
+    // Without parallel compile the driver works inside these calls
+    // and the status checks, the time in between isn't compiling
+    if (!ShaderCache::IsParallelCompileSupported())
+    {
+        m_compileMilliseconds = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - m_compileStart).count();
+    }
+}
 
-    Log::Info("Shader %i compiled successfully!", ID);
+void Shader::Finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+
+    bool compiled = m_vert != 0;
+
+    if (compiled)
+    {
+        auto waitStart = std::chrono::steady_clock::now();
+
+        CheckCompilerErrors(m_vert, EShaderType::Vertex);
+        CheckCompilerErrors(m_frag, EShaderType::Fragment);
+        CheckCompilerErrors(ID, EShaderType::Program);
+
+        auto waitEnd = std::chrono::steady_clock::now();
+
+        if (!ShaderCache::IsParallelCompileSupported())
+        {
+            m_compileMilliseconds += std::chrono::duration<float, std::milli>(
+                waitEnd - waitStart).count();
+        }
+        else
+        {
+            // Not polled before, done by the time the statuses are in
+            if (m_compileEnd == std::chrono::steady_clock::time_point())
+            {
+                m_compileEnd = waitEnd;
+            }
+
+            m_compileMilliseconds = std::chrono::duration<float, std::milli>(
+                m_compileEnd - m_compileStart).count();
+        }
+
+        ShaderCache::Save(m_cacheKey, ID, m_compileMilliseconds);
+
+        // Cleanup
+        glDeleteShader(m_vert);
+        glDeleteShader(m_frag);
+
+        m_vert = 0;
+        m_frag = 0;
+    }
+
+    ReflectUniforms();
+
+    // Attach the shared per-frame block, if the program uses it.
+    // Not part of the binary, so cached programs need it as well.
+    unsigned int frameBlock = glGetUniformBlockIndex(
+        ID,
+        FRAME_DATA_BLOCK_NAME
+    );
+
+    if (frameBlock != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
+    }
+
+    m_finished = true;
+
+    Log::Info(
+        "Shader %i %s successfully!",
+        ID,
+        compiled ? "compiled" : "loaded from cache"
+    );
+}
+
+bool Shader::IsReady() const
+{
+    if (m_finished || m_vert == 0 || !ShaderCache::IsParallelCompileSupported())
+    {
+        return true;
+    }
+
+    // Link completion implies both shaders are done
+    int complete = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+
+    // Built on the driver's threads, so done is when it's first seen
+    if (complete == GL_TRUE &&
+        m_compileEnd == std::chrono::steady_clock::time_point())
+    {
+        m_compileEnd = std::chrono::steady_clock::now();
+    }
+
+    return complete == GL_TRUE;
+}
+
+bool Shader::IsFinished() const
+{
+    return m_finished;
 }
 
 void Shader::SetFloat(const char* name, float value)
 {
-    glUniform1f(
-        glGetUniformLocation(ID, name),
-        value
-    );
+    Set(Uniform<float>{ GetUniformLocation(name) }, value);
 }
 
 void Shader::SetInt(const char* name, int value)
 {
-    glUniform1i(
-        glGetUniformLocation(ID, name),
-        value
-    );
+    Set(Uniform<int>{ GetUniformLocation(name) }, value);
 }
 
 void Shader::SetVec2(const char* name, const glm::vec2& value)
 {
-    glUniform2f(
-        glGetUniformLocation(ID, name),
-        value.x,
-        value.y
-    );
+    Set(Uniform<glm::vec2>{ GetUniformLocation(name) }, value);
 }
 
 void Shader::SetVec3(const char* name, const glm::vec3& value)
 {
-    glUniform3f(
-        glGetUniformLocation(ID, name),
-        value.x,
-        value.y,
-        value.z
-    );
+    Set(Uniform<glm::vec3>{ GetUniformLocation(name) }, value);
 }
 
 void Shader::SetVec4(const char* name, const glm::vec4& value)
 {
-    glUniform4f(
-        glGetUniformLocation(ID, name),
-        value.x,
-        value.y,
-        value.z,
-        value.w
-    );
+    Set(Uniform<glm::vec4>{ GetUniformLocation(name) }, value);
 }
 
 void Shader::SetMat4(const char* name, const glm::mat4& value)
 {
-    glUniformMatrix4fv(
-        glGetUniformLocation(ID, name),
-        1,
-        false,
-        glm::value_ptr(value)
+    Set(Uniform<glm::mat4>{ GetUniformLocation(name) }, value);
+}
+
+void Shader::Set(Uniform<float> uniform, float value)
+{
+    GLState::Uniform(uniform.Location, &value, 1);
+}
+
+void Shader::Set(Uniform<int> uniform, int value)
+{
+    GLState::Uniform(uniform.Location, value);
+}
+
+void Shader::Set(Uniform<glm::vec2> uniform, const glm::vec2& value)
+{
+    GLState::Uniform(uniform.Location, glm::value_ptr(value), 2);
+}
+
+void Shader::Set(Uniform<glm::vec3> uniform, const glm::vec3& value)
+{
+    GLState::Uniform(uniform.Location, glm::value_ptr(value), 3);
+}
+
+void Shader::Set(Uniform<glm::vec4> uniform, const glm::vec4& value)
+{
+    GLState::Uniform(uniform.Location, glm::value_ptr(value), 4);
+}
+
+void Shader::Set(Uniform<glm::mat4> uniform, const glm::mat4& value)
+{
+    GLState::UniformMatrix4(uniform.Location, glm::value_ptr(value));
+}
+
+int Shader::GetUniformLocation(std::string_view name)
+{
+    auto it = m_uniformLocations.find(name);
+
+    if (it != m_uniformLocations.end())
+    {
+        return it->second;
+    }
+
+    // Not an active uniform; report it once and remember the miss.
+    // GL silently ignores uploads to location -1.
+    std::string nameStr(name);
+
+    Log::Warning(
+        "Shader %i has no active uniform '%s'!",
+        ID,
+        nameStr.c_str()
     );
+
+    m_uniformLocations.emplace(std::move(nameStr), -1);
+
+    return -1;
+}
+
+void Shader::ReflectUniforms()
+{
+    m_uniformLocations.clear();
+
+    int uniformCount = 0;
+    int maxNameLength = 0;
+
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string nameBuffer(maxNameLength, '\0');
+
+    for (int i = 0; i < uniformCount; i++)
+    {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+
+        glGetActiveUniform(
+            ID,
+            i,
+            maxNameLength,
+            &length,
+            &size,
+            &type,
+            nameBuffer.data()
+        );
+
+        std::string name(nameBuffer.data(), length);
+        int location = glGetUniformLocation(ID, name.c_str());
+
+        // Members of uniform blocks have no location
+        if (location == -1)
+        {
+            continue;
+        }
+
+        // Arrays are reported once as "name[0]", allow lookup by
+        // "name" and resolve every element
+        if (name.ends_with("[0]"))
+        {
+            std::string baseName = name.substr(0, name.size() - 3);
+
+            for (int element = 1; element < size; element++)
+            {
+                std::string elementName = std::format(
+                    "{}[{}]",
+                    baseName,
+                    element
+                );
+
+                m_uniformLocations.emplace(
+                    elementName,
+                    glGetUniformLocation(ID, elementName.c_str())
+                );
+            }
+
+            m_uniformLocations.emplace(std::move(baseName), location);
+        }
+
+        m_uniformLocations.emplace(std::move(name), location);
+    }
 }
 
 std::string Shader::ReadTextFile(const char* path)
 {
-    std::string line, text;
-    std::ifstream in(path);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
 
     if (!in.is_open() || in.bad())
     {
@@ -139,9 +357,57 @@ std::string Shader::ReadTextFile(const char* path)
         );
     }
 
-    while (std::getline(in, line))
+    // One read for the whole file
+    std::string source(in.tellg(), '\0');
+    in.seekg(0);
+    in.read(source.data(), (std::streamsize)source.size());
+
+    // Includes are resolved relative to the including file
+    std::string directory = path;
+    size_t slash = directory.find_last_of("/\\");
+    directory = (slash == std::string::npos) ?
+        "" : directory.substr(0, slash + 1);
+
+    std::string text;
+    text.reserve(source.size());
+
+    size_t lineStart = 0;
+
+    while (lineStart < source.size())
     {
-        text += line + "\n";
+        size_t lineEnd = source.find('\n', lineStart);
+
+        if (lineEnd == std::string::npos)
+        {
+            lineEnd = source.size();
+        }
+
+        std::string_view line(source.data() + lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (!line.starts_with("#include"))
+        {
+            text.append(line);
+            text += '\n';
+            continue;
+        }
+
+        size_t first = line.find('"');
+        size_t last = line.find_last_of('"');
+
+        if (first == std::string::npos || first == last)
+        {
+            Log::Critical(
+                "Malformed #include in %s: %s",
+                path,
+                std::string(line).c_str()
+            );
+        }
+
+        std::string includePath = directory +
+            std::string(line.substr(first + 1, last - first - 1));
+
+        text += ReadTextFile(includePath.c_str());
     }
 
     return text;
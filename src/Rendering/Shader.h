@@ -3,7 +3,33 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Resolved uniform location, typed by the value it accepts so hot
+// code can look a name up once and set it without string work
+template<typename T>
+struct Uniform
+{
+    int Location = -1;
+
+    [[nodiscard]]
+    bool IsValid() const
+    {
+        return Location != -1;
+    }
+};
+
+// Both stages with their includes expanded, and the cache key
+struct ShaderSource
+{
+    std::string Vert;
+    std::string Frag;
+    uint64_t Key = 0;
+};
 
 class Shader
 {
@@ -13,11 +39,38 @@ public:
     unsigned int ID;
 
     Shader& Use();
+
+    // Begin() and Finish() in one go
     void Load(
         const char* vertPath,
         const char* fragPath
     );
 
+    // Reads both stages, e.g. to find the program already built
+    [[nodiscard]]
+    static ShaderSource ReadSource(
+        const char* vertPath,
+        const char* fragPath
+    );
+
+    // Links the cached binary, or issues the compile and link without
+    // waiting on them so several programs can build at once
+    void Begin(
+        const char* vertPath,
+        const char* fragPath
+    );
+    void Begin(const ShaderSource& source);
+
+    // Waits for the program if it is still building, checks it and
+    // resolves its uniforms. Does nothing once finished.
+    void Finish();
+
+    // Finish() would not block
+    [[nodiscard]]
+    bool IsReady() const;
+    [[nodiscard]]
+    bool IsFinished() const;
+
     void SetFloat(
         const char* name,
         float value
@@ -43,7 +96,34 @@ public:
         const glm::mat4& value
     );
 
+    template<typename T>
+    Uniform<T> GetUniform(std::string_view name)
+    {
+        return { GetUniformLocation(name) };
+    }
+
+    int GetUniformLocation(std::string_view name);
+
+    void Set(Uniform<float> uniform, float value);
+    void Set(Uniform<int> uniform, int value);
+    void Set(Uniform<glm::vec2> uniform, const glm::vec2& value);
+    void Set(Uniform<glm::vec3> uniform, const glm::vec3& value);
+    void Set(Uniform<glm::vec4> uniform, const glm::vec4& value);
+    void Set(Uniform<glm::mat4> uniform, const glm::mat4& value);
+
 private:
+    // Allows lookups by const char* / string_view without
+    // constructing a std::string
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view value) const
+        {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
     enum EShaderType
     {
         Vertex,
@@ -51,6 +131,29 @@ private:
         Program
     };
 
-    std::string ReadTextFile(const char* path);
+    static std::string ReadTextFile(const char* path);
     void CheckCompilerErrors(unsigned int object, EShaderType type);
+    void ReflectUniforms();
+
+    // Only set while compiling, zero for cached programs
+    unsigned int m_vert = 0;
+    unsigned int m_frag = 0;
+
+    uint64_t m_cacheKey = 0;
+    bool m_finished = false;
+
+    // Stored with the binary. With parallel compile, from Begin()
+    // until the driver is first seen done with the program, else
+    // the time spent in the compile calls and waiting on them.
+    std::chrono::steady_clock::time_point m_compileStart;
+    mutable std::chrono::steady_clock::time_point m_compileEnd;
+    float m_compileMilliseconds = 0.0F;
+
+    // Active uniform locations, unknown names are cached as -1
+    std::unordered_map<
+        std::string,
+        int,
+        StringHash,
+        std::equal_to<>
+    > m_uniformLocations;
 };
@@ -0,0 +1,327 @@
+#include "ShaderCache.h"
+#include "Core/Log.h"
+#include "IO/MappedFile.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <vector>
+
+// "GLSB", bumped whenever the header changes
+#define SHADER_CACHE_MAGIC      0x42534C47
+#define SHADER_CACHE_VERSION    1
+
+// From KHR/ARB_parallel_shader_compile, which the loader may not have
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR    0x91B1
+#endif
+
+typedef void (APIENTRY *MaxShaderCompilerThreadsFunction)(GLuint count);
+
+std::string ShaderCache::m_directory;
+std::string ShaderCache::m_driver;
+
+bool ShaderCache::m_binariesSupported = false;
+bool ShaderCache::m_parallelCompile = false;
+
+int ShaderCache::m_hits = 0;
+int ShaderCache::m_misses = 0;
+
+float ShaderCache::m_cachedMilliseconds = 0.0F;
+float ShaderCache::m_compiledMilliseconds = 0.0F;
+float ShaderCache::m_savedMilliseconds = 0.0F;
+
+static bool HasExtension(const char* name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (int i = 0; i < count; i++)
+    {
+        auto extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+
+        if (extension && std::strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ShaderCache::Init(const char* directory)
+{
+    m_directory = directory;
+
+    m_driver = std::format(
+        "{}|{}|{}",
+        (const char*)glGetString(GL_VENDOR),
+        (const char*)glGetString(GL_RENDERER),
+        (const char*)glGetString(GL_VERSION)
+    );
+
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+    m_binariesSupported = formatCount > 0;
+
+    if (m_binariesSupported)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+
+        if (error)
+        {
+            Log::Warning(
+                "[ShaderCache] Unable to create %s: %s",
+                m_directory.c_str(),
+                error.message().c_str()
+            );
+            m_binariesSupported = false;
+        }
+    }
+    else
+    {
+        Log::Warning("[ShaderCache] The driver offers no program binary formats");
+    }
+
+    // Both extensions share the entry point's behaviour and the enum
+    const char* parallelFunction = nullptr;
+
+    if (HasExtension("GL_KHR_parallel_shader_compile"))
+    {
+        parallelFunction = "glMaxShaderCompilerThreadsKHR";
+    }
+    else if (HasExtension("GL_ARB_parallel_shader_compile"))
+    {
+        parallelFunction = "glMaxShaderCompilerThreadsARB";
+    }
+
+    auto maxCompilerThreads = parallelFunction ?
+        (MaxShaderCompilerThreadsFunction)glfwGetProcAddress(parallelFunction) :
+        nullptr;
+
+    m_parallelCompile = maxCompilerThreads != nullptr;
+
+    if (m_parallelCompile)
+    {
+        // As many threads as the driver wants
+        maxCompilerThreads(0xFFFFFFFF);
+    }
+
+    Log::Info(
+        "[ShaderCache] Binaries %s, parallel compile %s",
+        m_binariesSupported ? "enabled" : "disabled",
+        m_parallelCompile ? "enabled" : "unavailable"
+    );
+}
+
+uint64_t ShaderCache::GetKey(
+    const std::string& vertSource,
+    const std::string& fragSource)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    auto mix = [&hash](const std::string& text)
+    {
+        for (char c : text)
+        {
+            hash ^= (unsigned char)c;
+            hash *= 0x100000001B3ull;
+        }
+
+        // Keeps "ab" + "c" apart from "a" + "bc"
+        hash ^= 0xFF;
+        hash *= 0x100000001B3ull;
+    };
+
+    mix(m_driver);
+    mix(vertSource);
+    mix(fragSource);
+
+    return hash;
+}
+
+bool ShaderCache::Load(uint64_t key, unsigned int program)
+{
+    if (!m_binariesSupported)
+    {
+        m_misses += 1;
+        return false;
+    }
+
+    MappedFile file;
+
+    if (!file.Open(GetPath(key)) || file.GetSize() < sizeof(Header))
+    {
+        m_misses += 1;
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, file.GetData(), sizeof(Header));
+
+    // A hash collision or a file from another build
+    if (header.Magic != SHADER_CACHE_MAGIC ||
+        header.Version != SHADER_CACHE_VERSION ||
+        header.Key != key ||
+        file.GetSize() < sizeof(Header) + header.Size)
+    {
+        m_misses += 1;
+        return false;
+    }
+
+    glProgramBinary(
+        program,
+        header.Format,
+        file.GetData() + sizeof(Header),
+        (GLsizei)header.Size
+    );
+
+    // Drivers may still reject a binary they wrote, e.g. after an
+    // update that kept the version string
+    int linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (!linked)
+    {
+        Log::Warning(
+            "[ShaderCache] Binary %016llx was rejected, compiling instead",
+            (unsigned long long)key
+        );
+
+        m_misses += 1;
+        return false;
+    }
+
+    m_hits += 1;
+    m_cachedMilliseconds += header.CompileMilliseconds;
+
+    return true;
+}
+
+void ShaderCache::Save(
+    uint64_t key,
+    unsigned int program,
+    float compileMilliseconds)
+{
+    m_compiledMilliseconds += compileMilliseconds;
+
+    if (!m_binariesSupported)
+    {
+        return;
+    }
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+    {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    Header header = {};
+    header.Magic = SHADER_CACHE_MAGIC;
+    header.Version = SHADER_CACHE_VERSION;
+    header.Key = key;
+    header.Format = format;
+    header.Size = (uint32_t)length;
+    header.CompileMilliseconds = compileMilliseconds;
+
+    // Written aside and renamed, a crash never leaves half a binary
+    std::string path = GetPath(key);
+    std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+
+        out.write((const char*)&header, sizeof(Header));
+        out.write(binary.data(), length);
+
+        if (!out)
+        {
+            Log::Warning("[ShaderCache] Unable to write %s", path.c_str());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+
+    if (error)
+    {
+        Log::Warning(
+            "[ShaderCache] Unable to write %s: %s",
+            path.c_str(),
+            error.message().c_str()
+        );
+    }
+}
+
+bool ShaderCache::IsParallelCompileSupported()
+{
+    return m_parallelCompile;
+}
+
+void ShaderCache::PrepareProgram(unsigned int program)
+{
+    if (m_binariesSupported)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ShaderCache::Report(float loadMilliseconds)
+{
+    float coldMilliseconds = m_cachedMilliseconds + m_compiledMilliseconds;
+    m_savedMilliseconds = std::max(coldMilliseconds - loadMilliseconds, 0.0F);
+
+    if (m_hits == 0)
+    {
+        Log::Info(
+            "[ShaderCache] Compiled %i programs in %.2f ms",
+            m_misses,
+            loadMilliseconds
+        );
+        return;
+    }
+
+    Log::Info(
+        "[ShaderCache] %i programs cached, %i compiled, ready in %.2f ms "
+        "(~%.2f ms without the cache, %.2f ms saved)",
+        m_hits,
+        m_misses,
+        loadMilliseconds,
+        coldMilliseconds,
+        m_savedMilliseconds
+    );
+}
+
+int ShaderCache::GetHitCount()
+{
+    return m_hits;
+}
+
+int ShaderCache::GetMissCount()
+{
+    return m_misses;
+}
+
+float ShaderCache::GetSavedMilliseconds()
+{
+    return m_savedMilliseconds;
+}
+
+std::string ShaderCache::GetPath(uint64_t key)
+{
+    return std::format("{}/{:016x}.bin", m_directory, key);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Linked programs are written here, one file per source hash
+#define SHADER_CACHE_DIRECTORY  "shader_cache"
+
+// Linked program binaries kept on disk between runs. A cached
+// program is keyed by its expanded sources and the driver that
+// built it, so an edited shader or a driver update misses and is
+// compiled again. Programs are also compiled in parallel on the
+// driver's threads where KHR/ARB_parallel_shader_compile exists.
+class ShaderCache
+{
+public:
+    // Needs the context, call before the first shader is loaded
+    static void Init(const char* directory = SHADER_CACHE_DIRECTORY);
+
+    [[nodiscard]]
+    static uint64_t GetKey(
+        const std::string& vertSource,
+        const std::string& fragSource
+    );
+
+    // Links `program` from its cached binary, false (and the program
+    // left for compiling) if there is none or the driver rejects it
+    static bool Load(uint64_t key, unsigned int program);
+
+    // `compileMilliseconds` is kept to report what later hits save
+    static void Save(
+        uint64_t key,
+        unsigned int program,
+        float compileMilliseconds
+    );
+
+    // Whether compiling and linking can be polled instead of waited on
+    [[nodiscard]]
+    static bool IsParallelCompileSupported();
+
+    // Set before linking, drivers may not keep the binary otherwise
+    static void PrepareProgram(unsigned int program);
+
+    // Logs the hits and misses, and the start-up time saved against
+    // compiling everything, given how long loading took this run
+    static void Report(float loadMilliseconds);
+
+    [[nodiscard]]
+    static int GetHitCount();
+    [[nodiscard]]
+    static int GetMissCount();
+    [[nodiscard]]
+    static float GetSavedMilliseconds();
+
+private:
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Key;
+        uint32_t Format;
+        uint32_t Size;
+        float CompileMilliseconds;
+        uint32_t Padding;
+    };
+
+    static std::string GetPath(uint64_t key);
+
+    static std::string m_directory;
+
+    // Vendor, renderer and version, mixed into every key
+    static std::string m_driver;
+
+    static bool m_binariesSupported;
+    static bool m_parallelCompile;
+
+    static int m_hits;
+    static int m_misses;
+
+    // Compile time recorded with every hit, and spent on every miss.
+    // Together, what a start with no cache pays.
+    static float m_cachedMilliseconds;
+    static float m_compiledMilliseconds;
+    static float m_savedMilliseconds;
+};
@@ -1,9 +1,8 @@
 #include "AnimatedSprite.h"
+#include "Core/AnimationClock.h"
+#include "Core/Log.h"
 
-typedef std::chrono::high_resolution_clock Clock;
-typedef std::chrono::duration<float> FSec;
-
-#include "GLFW/glfw3.h"
+#include <algorithm>
 
 AnimatedSprite::AnimatedSprite(
     int divisions,
@@ -18,37 +17,34 @@ AnimatedSprite::AnimatedSprite(
             size,
             color)
 {
-    m_divisions = divisions;
-    m_frameDuration = frameDuration;
-
-    m_startTime = GetCurrentTime();
+    // Draw divides by one and wraps by the other
+    if (divisions < 1 || !(frameDuration >= ANIMATION_MIN_FRAME_DURATION))
+    {
+        Log::Warning(
+            "[AnimatedSprite] Invalid animation (%d divisions, %f s frames), clamped",
+            divisions,
+            frameDuration
+        );
+    }
+
+    m_divisions = std::max(divisions, 1);
+    m_frameDuration = frameDuration >= ANIMATION_MIN_FRAME_DURATION
+        ? frameDuration
+        : ANIMATION_MIN_FRAME_DURATION;
+
+    m_startTime = AnimationClock::GetTime();
 }
 
 void AnimatedSprite::Draw(std::shared_ptr<Camera>& camera)
 {
-    m_shader->Use();
-
-    m_shader->SetInt("xDivisions", m_divisions);
-
-    // Get elapsed time in seconds
-    double elapsedTime = glfwGetTime();
+    // Same clock as FlipbookComponent
+    // Started after a clock reset, hold the first frame
+    double elapsedTime = std::max(AnimationClock::GetTime() - m_startTime, 0.0);
 
     int frame = (int)(elapsedTime / m_frameDuration) % m_divisions;
-    m_shader->SetInt("frame", frame);
+    m_frame = glm::ivec3(m_divisions, 1, frame);
 
     Sprite::Draw(camera);
-
-    m_shader->SetInt("xDivisions", 1);
-    m_shader->SetInt("frame", 0);
-}
-
-float AnimatedSprite::GetCurrentTime()
-{
-    auto now = std::chrono::steady_clock::now();
-    auto timeInSeconds = std::chrono::duration_cast<std::chrono::duration<float>>(
-        now.time_since_epoch()
-    );
-    return timeInSeconds.count();
 }
 
 void AnimatedSprite::Update(float deltaTime)
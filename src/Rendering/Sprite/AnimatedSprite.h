@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Sprite.h"
-#include <chrono>
 
 class AnimatedSprite : public Sprite
 {
@@ -21,7 +20,7 @@ public:
 private:
     int m_divisions;
     float m_frameDuration;
-    float m_startTime;
 
-    float GetCurrentTime();
+    // AnimationClock time of the first frame
+    double m_startTime;
 };
@@ -1,6 +1,8 @@
 #include "Sprite.h"
 
+#include "Core/Math/Affine2D.h"
 #include "Rendering/Debug/DebugShapes.h"
+#include "Rendering/GLState.h"
 
 Sprite::Sprite(std::shared_ptr<Texture>& texture, glm::vec2 position, glm::vec2 size, glm::vec3 color)
     : Sprite(position, size, color)
@@ -26,74 +28,44 @@ Sprite::Sprite(glm::vec2 position, glm::vec2 size, glm::vec3 color)
 
 Sprite::~Sprite()
 {
-    glDeleteVertexArrays(1, &m_quadVAO);
+    GLState::DeleteVertexArray(m_quadVAO);
 }
 
 void Sprite::Draw(std::shared_ptr<Camera>& camera)
 {
     m_shader->Use();
 
-    // (Matrix transformations are applied in reverse order)
-    auto modelMatrix = glm::mat4(1.0F);
-    glm::vec2 offset = m_pivot * m_size;
-
-    // Translation
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(m_position, 0.0F));
-
-    // Reset pivot
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(offset, 0.0F));
-
-    // Rotation
-    modelMatrix = glm::rotate(modelMatrix, m_rotation, glm::vec3(0.0F, 0.0F, 1.0F));
-
-    // Flipping
-    if (m_flipHorizontal)
-    {
-        modelMatrix = glm::rotate(
-            modelMatrix,
-            glm::radians(180.0F),
-            glm::vec3(0.0F, 1.0F, 0.0F)
-        );
-    }
-    if (m_flipVertical)
-    {
-        modelMatrix = glm::rotate(
-            modelMatrix,
-            glm::radians(180.0F),
-            glm::vec3(1.0F, 0.0F, 0.0F)
-        );
-    }
-    if (m_flipDiagonal)
-    {
-        modelMatrix = glm::rotate(
-            modelMatrix,
-            glm::radians(180.0F),
-            glm::vec3(0.71F, 0.71F, 0.0F)
-        );
-    }
-
-    // Set pivot point
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(-offset, 0.0F));
-
-    // Sizing
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(m_size, 1.0F));
+    int flip =
+        (m_flipHorizontal ? SPRITE_FLIP_HORIZONTAL : 0) |
+        (m_flipVertical ? SPRITE_FLIP_VERTICAL : 0) |
+        (m_flipDiagonal ? SPRITE_FLIP_DIAGONAL : 0);
+
+    Affine2D model = Affine2D::FromTransform(
+        m_position,
+        m_size,
+        m_pivot,
+        m_rotation,
+        flip
+    );
 
     // Shader setup
-    m_shader->SetMat4("model", modelMatrix);
-    m_shader->SetVec3("spriteColor", m_color);
-    m_shader->SetMat4("projection", camera->GetProjection());
+    // sprite.vert reads these as per-instance attributes, a
+    // single sprite feeds them through the generic attribute values
+    glVertexAttrib4f(1, model.A, model.B, model.C, model.D);
+    glVertexAttrib2f(2, model.TX, model.TY);
+    glVertexAttrib4f(5, m_color.r, m_color.g, m_color.b, 1.0F);
+    glVertexAttribI4i(6, m_frame.x, m_frame.y, m_frame.z, 0);
+    glVertexAttrib4f(7, 0.0F, 0.0F, 1.0F, 1.0F);
 
     if (m_hasTexture)
     {
         m_shader->SetInt("image", 0);
-        glActiveTexture(GL_TEXTURE0);
-        m_texture->Bind();
+        m_texture->Bind(0);
     }
 
     // Bind VAO and draw geometry
-    glBindVertexArray(m_quadVAO);
+    GLState::BindVertexArray(m_quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 }
 
 void Sprite::DrawCollision(std::shared_ptr<Camera>& camera)
@@ -105,31 +77,7 @@ void Sprite::DrawCollision(std::shared_ptr<Camera>& camera)
 
     ColliderData colData = GetColliderData();
 
-    std::vector<glm::vec2> boxPoints;
-    boxPoints.reserve(4);
-
-    boxPoints.emplace_back(
-        colData.WorldOrigin.x - colData.WorldSize.x * 0.5F,
-        colData.WorldOrigin.y - colData.WorldSize.y * 0.5F
-    );
-    boxPoints.emplace_back(
-        colData.WorldOrigin.x - colData.WorldSize.x * 0.5F,
-        colData.WorldOrigin.y + colData.WorldSize.y * 0.5F
-    );
-    boxPoints.emplace_back(
-        colData.WorldOrigin.x + colData.WorldSize.x * 0.5F,
-        colData.WorldOrigin.y + colData.WorldSize.y * 0.5F
-    );
-    boxPoints.emplace_back(
-        colData.WorldOrigin.x + colData.WorldSize.x * 0.5F,
-        colData.WorldOrigin.y - colData.WorldSize.y * 0.5F
-    );
-    boxPoints.emplace_back(
-        colData.WorldOrigin.x - colData.WorldSize.x * 0.5F,
-        colData.WorldOrigin.y - colData.WorldSize.y * 0.5F
-    );
-
-    DebugShapes::DrawLine(boxPoints, camera);
+    DebugShapes::DrawBox(colData.WorldOrigin, colData.WorldSize);
 }
 
 void Sprite::InitRenderData()
@@ -150,7 +98,7 @@ void Sprite::InitRenderData()
     glGenVertexArrays(1, &m_quadVAO);
     glGenBuffers(1, &VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(
         GL_ARRAY_BUFFER,
         sizeof(vertices),
@@ -158,7 +106,7 @@ void Sprite::InitRenderData()
         GL_STATIC_DRAW
     );
 
-    glBindVertexArray(m_quadVAO);
+    GLState::BindVertexArray(m_quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(
         0,
@@ -168,8 +116,8 @@ void Sprite::InitRenderData()
         4 * sizeof(float),
         (void*)nullptr
     );
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
 }
 
 void Sprite::SetRotation(float rotation)
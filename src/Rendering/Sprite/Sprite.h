@@ -57,6 +57,9 @@ protected:
     bool m_flipVertical = false;
     bool m_flipDiagonal = false;
 
+    // x/y divisions and frame index
+    glm::ivec3 m_frame = glm::ivec3(1, 1, 0);
+
     unsigned int m_quadVAO;
 
 private:
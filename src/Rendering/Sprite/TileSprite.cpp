@@ -36,16 +36,9 @@ void TileSprite::SetCurrentTileIndex(int index)
 
 void TileSprite::Draw(std::shared_ptr<Camera> &camera)
 {
-    m_shader->Use();
-    m_shader->SetInt("xDivisions", m_divisions.x);
-    m_shader->SetInt("yDivisions", m_divisions.y);
-    m_shader->SetInt("frame", m_tileIndex);
+    m_frame = glm::ivec3(m_divisions.x, m_divisions.y, m_tileIndex);
 
     Sprite::Draw(camera);
-
-    m_shader->SetInt("xDivisions", 1);
-    m_shader->SetInt("yDivisions", 1);
-    m_shader->SetInt("frame", 0);
 }
 
 void TileSprite::Update(float deltaTime)
@@ -0,0 +1,194 @@
+#include "StreamBuffer.h"
+#include "Core/Log.h"
+#include "Rendering/GLState.h"
+
+#include <chrono>
+
+unsigned int StreamBuffer::m_buffer = 0;
+unsigned char* StreamBuffer::m_mapped = nullptr;
+
+size_t StreamBuffer::m_regionSize = 0;
+size_t StreamBuffer::m_cursor = 0;
+int StreamBuffer::m_region = 0;
+
+GLsync StreamBuffer::m_fences[STREAM_BUFFER_REGIONS] = {};
+
+bool StreamBuffer::m_grow = false;
+
+StreamBufferStats StreamBuffer::m_stats;
+
+void StreamBuffer::Init(size_t regionSize)
+{
+    CreateBuffer(regionSize);
+}
+
+void StreamBuffer::Destroy()
+{
+    DestroyBuffer();
+}
+
+void StreamBuffer::BeginFrame()
+{
+    // Last frame overflowed, trade the buffer for a bigger one
+    if (m_grow)
+    {
+        size_t regionSize = m_regionSize * 2;
+
+        DestroyBuffer();
+        CreateBuffer(regionSize);
+
+        m_grow = false;
+    }
+
+    m_region = (m_region + 1) % STREAM_BUFFER_REGIONS;
+    m_cursor = 0;
+
+    WaitForRegion(m_region);
+}
+
+void StreamBuffer::EndFrame()
+{
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_stats.BytesUsed = m_cursor;
+}
+
+StreamAllocation StreamBuffer::Allocate(size_t size, size_t alignment)
+{
+    size_t regionStart = m_regionSize * m_region;
+
+    // Align the absolute offset, so offsets can be turned into
+    // vertex or instance indices by dividing by the stride
+    size_t offset = regionStart + m_cursor;
+    offset = (offset + alignment - 1) / alignment * alignment;
+
+    if (offset + size > regionStart + m_regionSize)
+    {
+        if (!m_grow)
+        {
+            Log::Warning(
+                "[StreamBuffer] Region of %zu bytes is full, "
+                "growing next frame",
+                m_regionSize
+            );
+        }
+
+        m_grow = true;
+        m_stats.Overflows += 1;
+
+        return {};
+    }
+
+    m_cursor = offset + size - regionStart;
+
+    StreamAllocation allocation = {};
+    allocation.Data = m_mapped + offset;
+    allocation.Offset = offset;
+    allocation.Size = size;
+
+    return allocation;
+}
+
+unsigned int StreamBuffer::GetID()
+{
+    return m_buffer;
+}
+
+const StreamBufferStats& StreamBuffer::GetStats()
+{
+    return m_stats;
+}
+
+void StreamBuffer::CreateBuffer(size_t regionSize)
+{
+    m_regionSize = regionSize;
+    m_stats.RegionSize = regionSize;
+
+    GLsizeiptr totalSize = (GLsizeiptr)(regionSize * STREAM_BUFFER_REGIONS);
+    GLbitfield flags =
+        GL_MAP_WRITE_BIT |
+        GL_MAP_PERSISTENT_BIT |
+        GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &m_buffer);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+
+    m_mapped = (unsigned char*)glMapBufferRange(
+        GL_ARRAY_BUFFER,
+        0,
+        totalSize,
+        flags
+    );
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!m_mapped)
+    {
+        Log::Critical("[StreamBuffer] Unable to map stream buffer!");
+    }
+
+    Log::Info(
+        "[StreamBuffer] Stream buffer created: [%i x %zu bytes]",
+        STREAM_BUFFER_REGIONS,
+        regionSize
+    );
+}
+
+void StreamBuffer::DestroyBuffer()
+{
+    // Nothing may still read from the buffer
+    for (int i = 0; i < STREAM_BUFFER_REGIONS; i++)
+    {
+        WaitForRegion(i);
+    }
+
+    if (m_buffer != 0)
+    {
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        GLState::DeleteBuffer(m_buffer);
+    }
+
+    m_buffer = 0;
+    m_mapped = nullptr;
+    m_cursor = 0;
+}
+
+void StreamBuffer::WaitForRegion(int region)
+{
+    GLsync fence = m_fences[region];
+
+    if (!fence)
+    {
+        return;
+    }
+
+    // Usually signalled long ago
+    GLenum result = glClientWaitSync(fence, 0, 0);
+
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        do
+        {
+            result = glClientWaitSync(
+                fence,
+                GL_SYNC_FLUSH_COMMANDS_BIT,
+                1000000
+            );
+        } while (result == GL_TIMEOUT_EXPIRED);
+
+        auto end = std::chrono::steady_clock::now();
+
+        m_stats.FenceWaits += 1;
+        m_stats.LastWaitMilliseconds =
+            std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    glDeleteSync(fence);
+    m_fences[region] = nullptr;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// Frames the CPU may run ahead of the GPU, one buffer region each
+#define STREAM_BUFFER_REGIONS       3
+#define STREAM_BUFFER_REGION_SIZE   (4 * 1024 * 1024)
+
+struct StreamAllocation
+{
+    // Persistently mapped memory to write to, null if the
+    // region ran out of space
+    void* Data = nullptr;
+
+    // Offset from the start of the buffer (not the region)
+    size_t Offset = 0;
+    size_t Size = 0;
+};
+
+struct StreamBufferStats
+{
+    // Frames that had to wait for the GPU to release a region
+    int FenceWaits = 0;
+    double LastWaitMilliseconds = 0.0;
+
+    // Bytes allocated in the last finished frame
+    size_t BytesUsed = 0;
+    size_t RegionSize = 0;
+
+    int Overflows = 0;
+};
+
+// One persistently mapped, coherent buffer split into a region per
+// frame in flight. Dynamic vertex and instance data is
+// sub-allocated from the current region on the GL thread when a
+// command list is replayed. A fence per region keeps
+// the CPU from overwriting data the GPU has not consumed yet.
+class StreamBuffer
+{
+public:
+    static void Init(size_t regionSize = STREAM_BUFFER_REGION_SIZE);
+    static void Destroy();
+
+    // Waits until the GPU is done with the next region
+    static void BeginFrame();
+
+    // Fences the current region, call after its last draw
+    static void EndFrame();
+
+    // Alignment may be any size (e.g. a vertex stride), the
+    // returned offset is a multiple of it
+    static StreamAllocation Allocate(size_t size, size_t alignment = 16);
+
+    static unsigned int GetID();
+
+    // GL thread only, others read RenderThread::GetStats()
+    static const StreamBufferStats& GetStats();
+
+private:
+    static void CreateBuffer(size_t regionSize);
+    static void DestroyBuffer();
+    static void WaitForRegion(int region);
+
+    static unsigned int m_buffer;
+    static unsigned char* m_mapped;
+
+    static size_t m_regionSize;
+    static size_t m_cursor;
+    static int m_region;
+
+    static GLsync m_fences[STREAM_BUFFER_REGIONS];
+
+    // Set on overflow, the buffer doubles at the next BeginFrame()
+    static bool m_grow;
+
+    static StreamBufferStats m_stats;
+};
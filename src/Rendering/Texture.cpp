@@ -1,10 +1,19 @@
 #include "Texture.h"
+#include "Rendering/GLState.h"
+#include "IO/CookedTexture.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 Texture::Texture()
+    : Texture(0)
 {
+    glGenTextures(1, &ID);
+}
+
+Texture::Texture(unsigned int id)
+{
+    ID = id;
     Width = 0;
     Height = 0;
     InternalFormat = GL_RGB;
@@ -13,12 +22,28 @@ Texture::Texture()
     WrapT = GL_CLAMP;
     FilterMin = GL_NEAREST;
     FilterMag = GL_NEAREST;
-
-    glGenTextures(1, &ID);
+    Divisions = glm::ivec2(1);
 }
 
 void Texture::LoadTexture(const char *path)
 {
+    // Uploaded straight from the mapped file
+    if (auto cooked = CookedTexture::Open(path))
+    {
+        const CookedTextureHeader& header = cooked->GetHeader();
+
+        Divisions = glm::ivec2(header.DivisionsX, header.DivisionsY);
+        Generate(
+            (int)header.Width,
+            (int)header.Height,
+            cooked->GetTexels(),
+            (int)header.InternalFormat,
+            (int)header.Format,
+            (int)header.Type
+        );
+        return;
+    }
+
     int width, height, channels;
     unsigned char* data = stbi_load(
         path,
@@ -28,17 +53,27 @@ void Texture::LoadTexture(const char *path)
         STBI_rgb_alpha
     );
 
+    // Images are always expanded to RGBA
+    Generate(width, height, data);
+
+    // Unload texture
+    stbi_image_free(data);
+}
+
+void Texture::Generate(
+    int width,
+    int height,
+    const unsigned char* data,
+    int internalFormat,
+    int imageFormat,
+    int type)
+{
     Width = width;
     Height = height;
+    InternalFormat = internalFormat;
+    ImageFormat = imageFormat;
 
-    // Check for alpha channel
-    if (channels == 4)
-    {
-        InternalFormat = GL_RGBA;
-        ImageFormat = GL_RGBA;
-    }
-
-    glBindTexture(GL_TEXTURE_2D, ID);
+    GLState::BindTexture(0, ID);
     glTexImage2D(
         GL_TEXTURE_2D,
         0,
@@ -47,7 +82,7 @@ void Texture::LoadTexture(const char *path)
         Height,
         0,
         ImageFormat,
-        GL_UNSIGNED_BYTE,
+        type,
         data
     );
 
@@ -57,13 +92,10 @@ void Texture::LoadTexture(const char *path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, FilterMag);
 
     // Unbind
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Unload texture
-    stbi_image_free(data);
+    GLState::BindTexture(0, 0);
 }
 
-void Texture::Bind() const
+void Texture::Bind(unsigned int unit) const
 {
-    glBindTexture(GL_TEXTURE_2D, ID);
+    GLState::BindTexture(unit, ID);
 }
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
 
 class Texture
 {
 public:
     Texture();
 
+    // Adopts a name created elsewhere (e.g. on the GL thread)
+    // instead of generating one
+    explicit Texture(unsigned int id);
+
     unsigned int ID;
     int Width;
     int Height;
@@ -17,6 +23,39 @@ public:
     int FilterMin;
     int FilterMag;
 
+    // Tile grid of the image, known for cooked textures
+    glm::ivec2 Divisions;
+
+    // Uploads the cooked twin of `path` if it is up to date,
+    // otherwise decodes the image
     void LoadTexture(const char* path);
-    void Bind() const;
+    void Generate(
+        int width,
+        int height,
+        const unsigned char* data,
+        int internalFormat = GL_RGBA,
+        int imageFormat = GL_RGBA,
+        int type = GL_UNSIGNED_BYTE
+    );
+    void Bind(unsigned int unit = 0) const;
+};
+
+// Rectangle of a texture (usually an atlas page) in pixels
+struct TextureRegion
+{
+    std::shared_ptr<Texture> Page;
+    glm::ivec2 Offset = { 0, 0 };
+    glm::ivec2 Size = { 0, 0 };
+
+    // Normalized (u0, v0, u1, v1)
+    [[nodiscard]]
+    glm::vec4 GetUVRect() const
+    {
+        glm::vec2 pageSize = glm::vec2(Page->Width, Page->Height);
+
+        return {
+            glm::vec2(Offset) / pageSize,
+            glm::vec2(Offset + Size) / pageSize
+        };
+    }
 };
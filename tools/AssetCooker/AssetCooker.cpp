@@ -0,0 +1,300 @@
+// Cooks every PNG under a directory into a .ctex file next to it: a
+// 64 byte header and RGBA8 texels in upload order, which the game
+// maps and hands to glTexImage2D without decoding. Files cooked from
+// an unchanged source are skipped.
+//
+// With --bench, times loading the whole set from PNG (cold, what an
+// uncooked start-up does) against mapping the cooked files (warm).
+//
+// Usage: asset_cooker <directory> [--tiles <file.png> <x> <y>]...
+//                     [--force] [--bench [runs]]
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "IO/CookedTexture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct TileGrid
+{
+    int X = 1;
+    int Y = 1;
+};
+
+static std::vector<fs::path> FindImages(const fs::path& directory)
+{
+    std::vector<fs::path> images;
+
+    for (const auto& entry : fs::recursive_directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".png")
+        {
+            images.emplace_back(entry.path());
+        }
+    }
+
+    // Stable output between runs
+    std::sort(images.begin(), images.end());
+
+    return images;
+}
+
+static bool CookImage(const fs::path& path, TileGrid tiles, bool force)
+{
+    std::string source = path.string();
+
+    if (!force)
+    {
+        auto cooked = CookedTexture::Open(source);
+
+        if (cooked &&
+            cooked->GetHeader().DivisionsX == (uint32_t)tiles.X &&
+            cooked->GetHeader().DivisionsY == (uint32_t)tiles.Y)
+        {
+            std::printf("  up to date  %s\n", source.c_str());
+            return true;
+        }
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    unsigned char* pixels = stbi_load(
+        source.c_str(),
+        &width,
+        &height,
+        &channels,
+        STBI_rgb_alpha
+    );
+
+    if (!pixels)
+    {
+        std::fprintf(
+            stderr,
+            "Unable to decode %s: %s\n",
+            source.c_str(),
+            stbi_failure_reason()
+        );
+        return false;
+    }
+
+    bool written = CookedTexture::Write(
+        source,
+        pixels,
+        width,
+        height,
+        tiles.X,
+        tiles.Y
+    );
+
+    stbi_image_free(pixels);
+
+    if (!written)
+    {
+        std::fprintf(
+            stderr,
+            "Unable to write %s\n",
+            CookedTexture::GetCookedPath(source).c_str()
+        );
+        return false;
+    }
+
+    std::printf(
+        "  cooked      %s (%ix%i, %ix%i tiles)\n",
+        source.c_str(),
+        width,
+        height,
+        tiles.X,
+        tiles.Y
+    );
+
+    return true;
+}
+
+template<typename Function>
+static double Measure(int runs, Function&& function)
+{
+    double best = 1e30;
+
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+
+        best = std::min(
+            best,
+            std::chrono::duration<double, std::milli>(end - start).count()
+        );
+    }
+
+    return best;
+}
+
+static void Bench(const std::vector<fs::path>& images, int runs)
+{
+    // Keeps the texel reads from being optimized out
+    volatile uint32_t checksum = 0;
+    size_t texelBytes = 0;
+
+    double coldTime = Measure(runs, [&]()
+    {
+        for (const fs::path& path : images)
+        {
+            int width, height, channels;
+            unsigned char* pixels = stbi_load(
+                path.string().c_str(),
+                &width,
+                &height,
+                &channels,
+                STBI_rgb_alpha
+            );
+
+            if (pixels)
+            {
+                checksum = checksum + pixels[0];
+                stbi_image_free(pixels);
+            }
+        }
+    });
+
+    int missing = 0;
+
+    double warmTime = Measure(runs, [&]()
+    {
+        texelBytes = 0;
+        missing = 0;
+
+        for (const fs::path& path : images)
+        {
+            auto cooked = CookedTexture::Open(path.string());
+
+            if (!cooked)
+            {
+                missing += 1;
+                continue;
+            }
+
+            // Touch every page, as the upload would
+            const unsigned char* texels = cooked->GetTexels();
+            size_t size = cooked->GetHeader().DataSize;
+
+            for (size_t i = 0; i < size; i += 4096)
+            {
+                checksum = checksum + texels[i];
+            }
+
+            texelBytes += size;
+        }
+    });
+
+    std::printf("\n%zu images, best of %i runs\n", images.size(), runs);
+    std::printf("  cold (PNG decode)   %8.3f ms\n", coldTime);
+    std::printf(
+        "  warm (cooked mmap)  %8.3f ms  (%zu KiB of texels)\n",
+        warmTime,
+        texelBytes / 1024
+    );
+
+    if (missing > 0)
+    {
+        std::printf("  %i images have no up to date cooked file\n", missing);
+    }
+    else if (warmTime > 0.0)
+    {
+        std::printf("  %.1fx faster\n", coldTime / warmTime);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(
+            stderr,
+            "Usage: asset_cooker <directory> [--tiles <file.png> <x> <y>]... "
+            "[--force] [--bench [runs]]\n"
+        );
+        return 1;
+    }
+
+    fs::path directory = argv[1];
+    std::map<fs::path, TileGrid> tileGrids;
+    bool force = false;
+    int benchRuns = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--tiles") == 0 && i + 3 < argc)
+        {
+            // Relative to the directory
+            fs::path image = (directory / argv[i + 1]).lexically_normal();
+
+            tileGrids[image] = {
+                std::max(std::atoi(argv[i + 2]), 1),
+                std::max(std::atoi(argv[i + 3]), 1)
+            };
+            i += 3;
+        }
+        else if (std::strcmp(argv[i], "--force") == 0)
+        {
+            force = true;
+        }
+        else if (std::strcmp(argv[i], "--bench") == 0)
+        {
+            benchRuns = 5;
+
+            if (i + 1 < argc && std::isdigit((unsigned char)argv[i + 1][0]))
+            {
+                benchRuns = std::max(std::atoi(argv[++i]), 1);
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!fs::is_directory(directory))
+    {
+        std::fprintf(stderr, "%s is not a directory\n", directory.string().c_str());
+        return 1;
+    }
+
+    std::vector<fs::path> images = FindImages(directory);
+    int failed = 0;
+
+    std::printf("Cooking %zu images in %s\n", images.size(), directory.string().c_str());
+
+    for (const fs::path& image : images)
+    {
+        auto grid = tileGrids.find(image.lexically_normal());
+        TileGrid tiles = grid != tileGrids.end() ? grid->second : TileGrid();
+
+        if (!CookImage(image, tiles, force))
+        {
+            failed += 1;
+        }
+    }
+
+    if (benchRuns > 0)
+    {
+        Bench(images, benchRuns);
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+// Generates large Tiled maps for benchmarking the chunked tilemap mode.
+// Layers are written base64 encoded so multi-million tile maps stay
+// loadable. Uses the same tilesets (and first GIDs) as level.json.
+//
+// Usage: map_generator <output.json> [width] [height] [seed]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+const uint32_t FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
+const uint32_t FLIPPED_VERTICALLY_FLAG   = 0x40000000;
+const uint32_t FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
+
+// First GIDs and tile counts of the tilesets used by level.json
+const uint32_t MAZE_FIRST_GID = 1;
+const uint32_t MAZE_TILE_COUNT = 12;
+const uint32_t DOTS_FIRST_GID = 13;
+const uint32_t DOTS_TILE_COUNT = 2;
+
+static void WriteBase64Layer(
+    std::ofstream& out,
+    const std::vector<uint32_t>& gids)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    auto bytes = reinterpret_cast<const uint8_t*>(gids.data());
+    size_t length = gids.size() * sizeof(uint32_t);
+
+    std::string line;
+    line.reserve(4096);
+
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t block = (uint32_t)bytes[i] << 16;
+
+        if (i + 1 < length)
+        {
+            block |= (uint32_t)bytes[i + 1] << 8;
+        }
+        if (i + 2 < length)
+        {
+            block |= bytes[i + 2];
+        }
+
+        line += alphabet[(block >> 18) & 0x3F];
+        line += alphabet[(block >> 12) & 0x3F];
+        line += (i + 1 < length) ? alphabet[(block >> 6) & 0x3F] : '=';
+        line += (i + 2 < length) ? alphabet[block & 0x3F] : '=';
+
+        if (line.size() >= 4092)
+        {
+            out << line;
+            line.clear();
+        }
+    }
+
+    out << line;
+}
+
+static void WriteLayer(
+    std::ofstream& out,
+    int id,
+    const char* name,
+    int width,
+    int height,
+    const std::vector<uint32_t>& gids)
+{
+    out << "  {\n";
+    out << "   \"compression\":\"\",\n";
+    out << "   \"data\":\"";
+    WriteBase64Layer(out, gids);
+    out << "\",\n";
+    out << "   \"encoding\":\"base64\",\n";
+    out << "   \"height\":" << height << ",\n";
+    out << "   \"id\":" << id << ",\n";
+    out << "   \"name\":\"" << name << "\",\n";
+    out << "   \"opacity\":1,\n";
+    out << "   \"type\":\"tilelayer\",\n";
+    out << "   \"visible\":true,\n";
+    out << "   \"width\":" << width << ",\n";
+    out << "   \"x\":0,\n";
+    out << "   \"y\":0\n";
+    out << "  }";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <output.json> [width] [height] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    const char* outputPath = argv[1];
+    int width = argc > 2 ? atoi(argv[2]) : 4096;
+    int height = argc > 3 ? atoi(argv[3]) : 4096;
+    unsigned int seed = argc > 4 ? (unsigned int)atoi(argv[4]) : 1337;
+
+    if (width <= 0 || height <= 0)
+    {
+        fprintf(stderr, "Invalid map size %ix%i\n", width, height);
+        return 1;
+    }
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<uint32_t> mazeTile(0, MAZE_TILE_COUNT - 1);
+    std::uniform_int_distribution<uint32_t> dotTile(0, DOTS_TILE_COUNT - 1);
+    std::uniform_int_distribution<uint32_t> flips(0, 7);
+    std::uniform_int_distribution<int> chance(0, 99);
+
+    std::vector<uint32_t> maze((size_t)width * height, 0);
+    std::vector<uint32_t> dots((size_t)width * height, 0);
+
+    // Wall tiles with random orientations, dots in the corridors
+    for (size_t i = 0; i < maze.size(); i++)
+    {
+        if (chance(random) < 40)
+        {
+            uint32_t flip = flips(random);
+            uint32_t gid = MAZE_FIRST_GID + mazeTile(random);
+
+            gid |= (flip & 1) ? FLIPPED_HORIZONTALLY_FLAG : 0;
+            gid |= (flip & 2) ? FLIPPED_VERTICALLY_FLAG : 0;
+            gid |= (flip & 4) ? FLIPPED_DIAGONALLY_FLAG : 0;
+
+            maze[i] = gid;
+        }
+        else if (chance(random) < 70)
+        {
+            dots[i] = DOTS_FIRST_GID + dotTile(random);
+        }
+    }
+
+    std::ofstream out(outputPath, std::ios::binary);
+
+    if (!out.is_open())
+    {
+        fprintf(stderr, "Unable to open %s for writing\n", outputPath);
+        return 1;
+    }
+
+    out << "{ \"compressionlevel\":-1,\n";
+    out << " \"height\":" << height << ",\n";
+    out << " \"infinite\":false,\n";
+    out << " \"layers\":[\n";
+    WriteLayer(out, 1, "Maze", width, height, maze);
+    out << ",\n";
+    WriteLayer(out, 2, "Dots", width, height, dots);
+    out << "],\n";
+    out << " \"nextlayerid\":3,\n";
+    out << " \"nextobjectid\":1,\n";
+    out << " \"orientation\":\"orthogonal\",\n";
+    out << " \"renderorder\":\"right-down\",\n";
+    out << " \"tileheight\":8,\n";
+    out << " \"tilesets\":[\n";
+    out << "  { \"firstgid\":1, \"source\":\"maze_tileset.tsx\" },\n";
+    out << "  { \"firstgid\":13, \"source\":\"dots.tsx\" },\n";
+    out << "  { \"firstgid\":15, \"source\":\"movement_path.tsx\" }],\n";
+    out << " \"tilewidth\":8,\n";
+    out << " \"type\":\"map\",\n";
+    out << " \"version\":\"1.10\",\n";
+    out << " \"width\":" << width << "\n";
+    out << "}\n";
+
+    printf("Wrote %ix%i map (%zu tiles per layer) to %s\n",
+        width,
+        height,
+        maze.size(),
+        outputPath
+    );
+
+    return 0;
+}
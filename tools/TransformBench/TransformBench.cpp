@@ -0,0 +1,231 @@
+// Compares the batched 2D affine kernels against the glm mat4 chain
+// sprites used to be transformed with (including the 3D flip rotations).
+//
+// Usage: transform_bench [sprites=100000] [iterations=200]
+
+#include "Core/Math/Affine2D.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+struct SpriteData
+{
+    std::vector<float> PositionX;
+    std::vector<float> PositionY;
+    std::vector<float> SizeX;
+    std::vector<float> SizeY;
+    std::vector<float> PivotX;
+    std::vector<float> PivotY;
+    std::vector<float> Rotation;
+    std::vector<uint8_t> Flip;
+
+    AffineBatch GetBatch() const
+    {
+        AffineBatch batch = {};
+        batch.PositionX = PositionX.data();
+        batch.PositionY = PositionY.data();
+        batch.SizeX = SizeX.data();
+        batch.SizeY = SizeY.data();
+        batch.PivotX = PivotX.data();
+        batch.PivotY = PivotY.data();
+        batch.Rotation = Rotation.data();
+        batch.Flip = Flip.data();
+        batch.Count = PositionX.size();
+
+        return batch;
+    }
+};
+
+static SpriteData GenerateSprites(size_t count)
+{
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(0.0F, 1000.0F);
+    std::uniform_real_distribution<float> size(8.0F, 64.0F);
+    std::uniform_real_distribution<float> rotation(-6.3F, 6.3F);
+
+    SpriteData data;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        data.PositionX.emplace_back(position(random));
+        data.PositionY.emplace_back(position(random));
+        data.SizeX.emplace_back(size(random));
+        data.SizeY.emplace_back(size(random));
+        data.PivotX.emplace_back(0.5F);
+        data.PivotY.emplace_back(0.5F);
+        data.Rotation.emplace_back(rotation(random));
+        data.Flip.emplace_back((uint8_t)(random() & 7));
+    }
+
+    return data;
+}
+
+// The per-sprite matrix chain Renderer::RenderSprites used before
+static glm::mat4 ComputeGLM(const SpriteData& data, size_t i)
+{
+    glm::vec2 position = { data.PositionX[i], data.PositionY[i] };
+    glm::vec2 size = { data.SizeX[i], data.SizeY[i] };
+    glm::vec2 offset = glm::vec2(data.PivotX[i], data.PivotY[i]) * size;
+
+    auto modelMatrix = glm::mat4(1.0F);
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(position, 0.0F));
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(offset, 0.0F));
+    modelMatrix = glm::rotate(
+        modelMatrix,
+        data.Rotation[i],
+        glm::vec3(0.0F, 0.0F, 1.0F)
+    );
+
+    if (data.Flip[i] & SPRITE_FLIP_HORIZONTAL)
+    {
+        modelMatrix = glm::rotate(
+            modelMatrix,
+            glm::radians(180.0F),
+            glm::vec3(0.0F, 1.0F, 0.0F)
+        );
+    }
+    if (data.Flip[i] & SPRITE_FLIP_VERTICAL)
+    {
+        modelMatrix = glm::rotate(
+            modelMatrix,
+            glm::radians(180.0F),
+            glm::vec3(1.0F, 0.0F, 0.0F)
+        );
+    }
+    if (data.Flip[i] & SPRITE_FLIP_DIAGONAL)
+    {
+        modelMatrix = glm::rotate(
+            modelMatrix,
+            glm::radians(180.0F),
+            glm::vec3(0.71F, 0.71F, 0.0F)
+        );
+    }
+
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(-offset, 0.0F));
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(size, 1.0F));
+
+    return modelMatrix;
+}
+
+// Best time of all iterations, in microseconds
+static double Measure(int iterations, const std::function<void()>& body)
+{
+    double best = 1e30;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+
+        best = std::min(
+            best,
+            std::chrono::duration<double, std::micro>(end - start).count()
+        );
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    SpriteData data = GenerateSprites(count);
+    AffineBatch batch = data.GetBatch();
+
+    std::vector<glm::mat4> matrices(count);
+    std::vector<Affine2D> models(count);
+    std::vector<Affine2D> reference(count);
+
+    ComputeAffines(batch, reference.data(), nullptr, EAffineKernel::Scalar);
+
+    std::printf("%zu sprites, best of %i runs\n\n", count, iterations);
+
+    double glmTime = Measure(iterations, [&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            matrices[i] = ComputeGLM(data, i);
+        }
+    });
+
+    // The old flips are only approximate (0.71 axis), report how far off
+    float glmError = 0.0F;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::mat4 expected = reference[i].ToMat4();
+
+        for (int column : { 0, 1, 3 })
+        {
+            for (int row = 0; row < 2; row++)
+            {
+                glmError = std::max(
+                    glmError,
+                    std::abs(matrices[i][column][row] - expected[column][row])
+                );
+            }
+        }
+    }
+
+    std::printf(
+        "%-8s %10.1f us  %8.1f sprites/us  max error %g\n",
+        "glm",
+        glmTime,
+        (double)count / glmTime,
+        glmError
+    );
+
+    EAffineKernel best = GetBestAffineKernel();
+
+    for (EAffineKernel kernel : {
+        EAffineKernel::Scalar,
+        EAffineKernel::SSE2,
+        EAffineKernel::AVX })
+    {
+        if (kernel > best)
+        {
+            continue;
+        }
+
+        double time = Measure(iterations, [&]()
+        {
+            ComputeAffines(batch, models.data(), nullptr, kernel);
+        });
+
+        float error = 0.0F;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* lhs = &models[i].A;
+            const float* rhs = &reference[i].A;
+
+            for (int j = 0; j < 6; j++)
+            {
+                error = std::max(error, std::abs(lhs[j] - rhs[j]));
+            }
+        }
+
+        std::printf(
+            "%-8s %10.1f us  %8.1f sprites/us  max error %g  (%.1fx glm)\n",
+            GetAffineKernelName(kernel),
+            time,
+            (double)count / time,
+            error,
+            glmTime / time
+        );
+    }
+
+    return 0;
+}